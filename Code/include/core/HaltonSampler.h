@@ -0,0 +1,25 @@
+#ifndef HALTON_SAMPLER_H
+#define HALTON_SAMPLER_H
+
+#include "core/Sampler.h"
+
+/**
+ * @class HaltonSampler
+ * @brief Randomized Halton sampler.
+ *        Dimension d is the radical inverse of the sample index in the d-th prime base, with the digits
+ *        Owen-scrambled per pixel: each digit is permuted by a hash of the pixel, dimension and the digits
+ *        before it. Dimensions past the prime table fall back to the bounce's PCG32 stream.
+ */
+class HaltonSampler : public Sampler
+{
+public:
+    /// Number of prime bases, and so Halton dimensions, available.
+    static constexpr uint32_t kMaxDimensions = 1024;
+
+    SamplerType type() const override { return SamplerType::HALTON; }
+
+protected:
+    float sample_dimension(uint32_t dimension) override;
+};
+
+#endif // HALTON_SAMPLER_H
@@ -3,45 +3,83 @@
 
 #include "core/Vec3.h"
 #include "scene/SceneConfig.h"
+
+#include <string>
 #include <vector>
 
 /**
  * @class ImportanceSampler
- * @brief A class for performing importance sampling in a ray tracing scene.
- *
- * The ImportanceSampler class is responsible for calculating the importance of
- * samples in a scene based on their luminance and other factors. It helps in
- * optimizing the rendering process by focusing more samples on important areas.
+ * @brief Decides how many samples the pixels of a tile receive from the variance of the samples taken so far.
  *
- * @param config The configuration of the scene.
- * @param min_samples The minimum number of samples to be taken.
- * @param max_samples The maximum number of samples to be taken.
+ * Every pixel first takes min_samples samples, then the whole tile takes further batches of batch_size until
+ * its error estimate falls below the threshold, or max_samples is reached. Converged regions therefore stop
+ * early, while dark and noisy ones keep sampling. Each pixel keeps a running mean and variance of its luminance
+ * (Welford's algorithm); the tile's error pools them, because a single pixel whose few samples all missed the
+ * light would otherwise report zero variance and stop while still black.
  *
+ * @param config The configuration of the scene, holding min_samples, max_samples, the batch size and the
+ *        relative error threshold.
  */
 class ImportanceSampler
 {
 public:
-    ImportanceSampler(const SceneConfig &config, int min_samples = 4, int max_samples = 64)
-        : config(config), min_samples(min_samples), max_samples(max_samples) {}
+    explicit ImportanceSampler(const SceneConfig &config)
+        : config(config) {}
+
     /**
      * @struct SampleStats
-     * @brief A structure to hold statistics about the samples.
+     * @brief The running statistics of one pixel's samples.
      */
     struct SampleStats
     {
-        Vec3 mean;
-        Vec3 variance;
-        int samples;
-        float importance;
+        Vec3 sum{0.0f, 0.0f, 0.0f}; ///< The sum of the sample colors.
+        float mean = 0.0f;          ///< The mean luminance of the samples.
+        float m2 = 0.0f;            ///< The sum of squared deviations of the luminance from the mean.
+        int samples = 0;            ///< The number of samples taken.
     };
 
     float calculate_luminance(const Vec3 &color) const;
-    float calculate_importance(const Vec3 &pixel_color) const;
+
+    /**
+     * @brief Adds a sample to a pixel's statistics.
+     * @param stats The pixel's statistics.
+     * @param color The radiance of the sample.
+     */
+    void add_sample(SampleStats &stats, const Vec3 &color) const;
+
+    /**
+     * @brief Estimates the relative error of a tile as displayed: the RMS standard error of its pixels' mean
+     *        luminance, carried through the tone mapper, divided by their mean displayed luminance.
+     *        Means below kMinLuminance are clamped so that dark tiles do not divide by zero.
+     * @param stats The statistics of every pixel in the tile.
+     * @param count The number of pixels in the tile.
+     * @return The tile's relative error, or infinity before every pixel has two samples.
+     */
+    float tile_error(const SampleStats *stats, int count) const;
+
+    /**
+     * @brief Returns the number of samples every pixel of a tile should have after its next batch, or samples
+     *        when the tile has converged or reached max_samples.
+     * @param samples The number of samples each pixel of the tile has taken.
+     * @param error The tile's current error, from tile_error().
+     */
+    int next_batch_end(int samples, float error) const;
+
+    /**
+     * @brief Writes a heatmap of the samples spent per pixel, from black at the fewest through red and
+     *        yellow to white at the most.
+     * @param config The configuration of the scene.
+     * @param sample_counts The number of samples taken by each pixel, indexed by y * width + x.
+     * @param filename The PPM file to write.
+     * @return True on success, false otherwise.
+     */
+    static bool save_heatmap(const SceneConfig &config, const std::vector<int> &sample_counts,
+                             const std::string &filename);
+
+    static constexpr float kMinLuminance = 0.05f; ///< The smallest mean displayed luminance the error divides by.
 
 private:
     const SceneConfig &config;
-    int min_samples;
-    int max_samples;
 };
 
 #endif
@@ -0,0 +1,52 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief A read-only memory mapping of a whole file. The mapping is released when the object is destroyed,
+ *        so data referring into it should hold a shared pointer to the MappedFile.
+ */
+class MappedFile
+{
+public:
+    /**
+     * @brief Maps a file into memory.
+     * @param filename The path of the file.
+     * @return The mapping, or nullptr if the file cannot be opened or mapped.
+     */
+    static std::shared_ptr<MappedFile> open(const std::string &filename);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Returns the first byte of the mapping. Mappings start on a page boundary.
+     */
+    const char *data() const { return bytes; }
+
+    /**
+     * @brief Returns the size of the file in bytes.
+     */
+    size_t size() const { return length; }
+
+private:
+    MappedFile() = default;
+
+    const char *bytes = nullptr; ///< Start of the mapped view.
+    size_t length = 0;           ///< Size of the mapped view in bytes.
+#ifdef _WIN32
+    void *file_handle = nullptr;    ///< Handle of the open file.
+    void *mapping_handle = nullptr; ///< Handle of the file mapping object.
+#endif
+};
+
+#endif // MAPPED_FILE_H
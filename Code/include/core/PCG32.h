@@ -0,0 +1,82 @@
+#ifndef PCG32_H
+#define PCG32_H
+
+#include <cstdint>
+
+/**
+ * @class PCG32
+ * @brief A small, fast permuted congruential generator (PCG-XSH-RR, 64-bit state, 32-bit output).
+ *        Each generator carries its own state, so every render thread can own one without locking,
+ *        and the stream selector lets many independent sequences share one seed.
+ */
+class PCG32
+{
+public:
+    /**
+     * @brief Constructs a generator for the given seed and stream.
+     * @param seed The starting position in the sequence.
+     * @param stream Selects one of 2^63 independent sequences.
+     */
+    explicit PCG32(uint64_t seed = 0x853c49e6748fea9bULL, uint64_t stream = 0xda3e39cb94b95bdbULL)
+    {
+        set_seed(seed, stream);
+    }
+
+    /**
+     * @brief Restarts the generator at the given seed and stream.
+     * @param seed The starting position in the sequence.
+     * @param stream Selects one of 2^63 independent sequences.
+     */
+    void set_seed(uint64_t seed, uint64_t stream)
+    {
+        state = 0u;
+        increment = (stream << 1u) | 1u;
+        next_uint();
+        state += seed;
+        next_uint();
+    }
+
+    /**
+     * @brief Returns the next uniformly distributed 32-bit value.
+     */
+    uint32_t next_uint()
+    {
+        uint64_t old_state = state;
+        state = old_state * kMultiplier + increment;
+        uint32_t xorshifted = static_cast<uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+        uint32_t rotation = static_cast<uint32_t>(old_state >> 59u);
+        return (xorshifted >> rotation) | (xorshifted << ((~rotation + 1u) & 31u));
+    }
+
+    /**
+     * @brief Returns a uniformly distributed value in [0, bound) without modulo bias.
+     * @param bound The exclusive upper limit; must be greater than zero.
+     */
+    uint32_t next_uint(uint32_t bound)
+    {
+        uint32_t threshold = (~bound + 1u) % bound;
+        while (true)
+        {
+            uint32_t r = next_uint();
+            if (r >= threshold)
+                return r % bound;
+        }
+    }
+
+    /**
+     * @brief Returns a uniformly distributed float in [0, 1).
+     */
+    float next_float()
+    {
+        // The top 24 bits fill the float mantissa exactly, so 1.0 is never returned
+        return static_cast<float>(next_uint() >> 8) * 0x1p-24f;
+    }
+
+private:
+    static constexpr uint64_t kMultiplier = 0x5851f42d4c957f2dULL; ///< LCG multiplier from the PCG reference.
+
+    uint64_t state;     ///< Current LCG state.
+    uint64_t increment; ///< Odd LCG increment; selects the stream.
+};
+
+#endif // PCG32_H
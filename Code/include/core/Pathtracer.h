@@ -27,14 +27,16 @@ public:
     /**
      * @brief Constructs a Pathtracer object with the given scene configuration.
      * @param config Reference to the scene configuration.
+     * @param materials The scene's materials, looked up by the material IDs of hit records.
      */
-    Pathtracer(SceneConfig &config) : scene_config(config) {}
+    Pathtracer(SceneConfig &config, const MaterialTable &materials) : scene_config(config), materials(materials) {}
 
     /**
      * @brief Traces a ray through the scene and computes the resulting color.
+     *        The path is followed iteratively and folded back to the camera once it ends.
      * @param ray The ray to trace.
      * @param world The world containing the objects to be hit by the ray.
-     * @param depth The current recursion depth for the ray tracing.
+     * @param depth The maximum number of path vertices.
      * @param lights The lights in the scene.
      * @return The computed color as a Vec3.
      */
@@ -42,6 +44,7 @@ public:
 
 private:
     SceneConfig &scene_config;
+    const MaterialTable &materials;
 
     /**
      * @brief Computes the background color for a given ray.
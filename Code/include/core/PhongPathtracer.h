@@ -5,6 +5,7 @@
 #include "geometry/Hittable.h"
 #include "lighting/HitRecord.h"
 #include "lighting/Light.h"
+#include "materials/MaterialTable.h"
 #include "scene/SceneConfig.h"
 #include "core/Vec3.h"
 
@@ -25,8 +26,9 @@ public:
      * @brief Constructs a PhongPathtracer with a specified maximum recursion depth.
      *
      * @param max_depth The maximum recursion depth for ray tracing.
+     * @param materials The scene's materials, looked up by the material IDs of hit records.
      */
-    PhongPathtracer(int max_depth);
+    PhongPathtracer(int max_depth, const MaterialTable &materials);
 
     /**
      * @brief Traces a ray through the scene and computes the color at the intersection point.
@@ -41,7 +43,8 @@ public:
     Vec3 trace(const Ray &ray, const Hittable &scene, int depth, SceneConfig &config, const std::vector<std::shared_ptr<Light>> lights) const;
 
 private:
-    int max_depth; // Maximum recursion depth
+    int max_depth;                  // Maximum recursion depth
+    const MaterialTable &materials; // Materials referenced by hit records
 };
 
 #endif // PhongPathtracer_H
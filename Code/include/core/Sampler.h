@@ -0,0 +1,104 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "core/PCG32.h"
+#include "scene/SceneConfig.h"
+
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class Sampler
+ * @brief Abstract source of the sample values used while rendering one camera sample.
+ *        Values are addressed by (seed, pixel, sample, bounce, dimension): every bounce owns a fixed
+ *        block of kDimensionsPerBounce dimensions, handed out in the order they are requested, so
+ *        the numbers drawn at one bounce never shift those of another. Requests beyond a bounce's
+ *        block fall back to a PCG32 stream derived from the same key.
+ */
+class Sampler
+{
+public:
+    /// Number of sampler dimensions reserved for each bounce.
+    static constexpr uint32_t kDimensionsPerBounce = 8;
+
+    /**
+     * @brief Virtual destructor for the Sampler class.
+     */
+    virtual ~Sampler() = default;
+
+    /**
+     * @brief Creates a sampler of the given type.
+     * @param type The sample generation strategy.
+     * @return A new sampler.
+     */
+    static std::unique_ptr<Sampler> create(SamplerType type);
+
+    /**
+     * @brief Returns the strategy this sampler implements.
+     */
+    virtual SamplerType type() const = 0;
+
+    /**
+     * @brief Starts a camera sample. Subsequent values belong to bounce 0 (pixel jitter and lens).
+     * @param seed Render seed.
+     * @param pixel_index Index of the pixel, y * width + x.
+     * @param sample_index Index of the sample within the pixel.
+     */
+    void start_sample(uint32_t seed, uint64_t pixel_index, uint32_t sample_index);
+
+    /**
+     * @brief Moves to the dimension block of a bounce of the current sample.
+     * @param bounce Path vertex index, 1 for the first surface hit.
+     */
+    void start_bounce(uint32_t bounce);
+
+    /**
+     * @brief Returns the next 1D sample value in [0, 1).
+     */
+    float get_1d();
+
+    /**
+     * @brief Returns the next 2D sample. The pair starts on an even dimension so that samplers
+     *        stratified in 2D keep the two values jointly well distributed.
+     * @param u1 Receives the first value in [0, 1).
+     * @param u2 Receives the second value in [0, 1).
+     */
+    void get_2d(float &u1, float &u2);
+
+protected:
+    /**
+     * @brief Returns one dimension of the current sample.
+     * @param dimension Absolute dimension index, bounce * kDimensionsPerBounce + offset.
+     * @return A value in [0, 1).
+     */
+    virtual float sample_dimension(uint32_t dimension) = 0;
+
+    /**
+     * @brief SplitMix64 finaliser, used to derive well spread seeds from structured keys.
+     */
+    static uint64_t mix_bits(uint64_t x);
+
+    uint32_t seed = 0;         ///< Render seed of the current sample.
+    uint64_t pixel_index = 0;  ///< Pixel of the current sample.
+    uint32_t sample_index = 0; ///< Index of the current sample within its pixel.
+    PCG32 rng;                 ///< Stream for the current bounce, used beyond the dimension block.
+
+private:
+    uint32_t bounce = 0;              ///< Bounce whose dimensions are being handed out.
+    uint32_t dimension_in_bounce = 0; ///< Next unused dimension within the bounce's block.
+};
+
+/**
+ * @class RandomSampler
+ * @brief Independent uniform random values: every dimension comes from the bounce's PCG32 stream.
+ */
+class RandomSampler : public Sampler
+{
+public:
+    SamplerType type() const override { return SamplerType::RANDOM; }
+
+protected:
+    float sample_dimension([[maybe_unused]] uint32_t dimension) override { return rng.next_float(); }
+};
+
+#endif // SAMPLER_H
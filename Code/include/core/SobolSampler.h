@@ -0,0 +1,23 @@
+#ifndef SOBOL_SAMPLER_H
+#define SOBOL_SAMPLER_H
+
+#include "core/Sampler.h"
+
+/**
+ * @class SobolSampler
+ * @brief Padded, Owen-scrambled Sobol sampler.
+ *        Dimensions are taken in pairs, each pair being the first two Sobol dimensions (a (0,2)-sequence).
+ *        Per pixel and pair the sample index is shuffled and each value Owen-scrambled with a hash-based
+ *        nested uniform scramble, which decorrelates pairs and pixels while keeping every pair stratified
+ *        for power-of-two sample counts.
+ */
+class SobolSampler : public Sampler
+{
+public:
+    SamplerType type() const override { return SamplerType::SOBOL; }
+
+protected:
+    float sample_dimension(uint32_t dimension) override;
+};
+
+#endif // SOBOL_SAMPLER_H
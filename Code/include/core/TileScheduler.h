@@ -0,0 +1,72 @@
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include <mutex>
+#include <vector>
+
+/**
+ * @struct Tile
+ * @brief A rectangle of pixels rendered as one unit of work, covering [x0, x1) x [y0, y1).
+ */
+struct Tile
+{
+    int x0, y0; ///< The top-left pixel of the tile.
+    int x1, y1; ///< One past the bottom-right pixel of the tile.
+
+    /**
+     * @brief Returns the number of pixels in the tile.
+     */
+    int pixel_count() const { return (x1 - x0) * (y1 - y0); }
+};
+
+/**
+ * @class TileScheduler
+ * @brief Hands out the tiles of an image to a fixed set of workers.
+ *        Tiles are ordered along a Morton curve over the tile grid, so consecutive tiles are neighbours on screen
+ *        and touch the same BVH nodes and texels. Each worker starts with one contiguous run of that order and
+ *        takes tiles from its front; a worker whose run is empty steals from the back of another's, which keeps
+ *        both runs compact while the load evens out.
+ */
+class TileScheduler
+{
+public:
+    /**
+     * @brief Splits an image into tiles and deals them out to the workers.
+     * @param width The image width in pixels.
+     * @param height The image height in pixels.
+     * @param tile_size The side of a square tile in pixels; edge tiles are cut to the image.
+     * @param n_workers The number of workers that will call next().
+     */
+    TileScheduler(int width, int height, int tile_size, int n_workers);
+
+    /**
+     * @brief Returns every tile of the image, in Morton order.
+     */
+    const std::vector<Tile> &tiles() const { return tile_list; }
+
+    /**
+     * @brief Takes the next tile for a worker, stealing one when its own run is exhausted.
+     * @param worker The calling worker, in [0, n_workers).
+     * @param tile_index Receives the index of the tile in tiles().
+     * @return False once every tile has been handed out.
+     */
+    bool next(int worker, int &tile_index);
+
+private:
+    /**
+     * @struct WorkerQueue
+     * @brief The run of tiles still owned by one worker, on its own cache line so that workers taking tiles do
+     *        not contend with each other.
+     */
+    struct alignas(64) WorkerQueue
+    {
+        std::mutex mutex; ///< Guards begin and end against thieves.
+        int begin = 0;    ///< The next tile the owner will take.
+        int end = 0;      ///< One past the tile a thief will take.
+    };
+
+    std::vector<Tile> tile_list;      ///< All tiles, in Morton order.
+    std::vector<WorkerQueue> queues;  ///< One run of tile_list per worker.
+};
+
+#endif // TILE_SCHEDULER_H
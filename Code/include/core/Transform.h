@@ -0,0 +1,91 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "core/Vec3.h"
+
+/**
+ * @class Transform
+ * @brief An affine transformation of 3D space, stored as the top three rows of a 4x4 matrix: a 3x3 linear
+ *        part and a translation column.
+ */
+class Transform
+{
+public:
+    /**
+     * @brief Creates the identity transformation.
+     */
+    Transform();
+
+    /**
+     * @brief Creates a transformation from the rows of its 3x4 matrix.
+     * @param rows Twelve values, row by row; the fourth value of each row is the translation.
+     */
+    explicit Transform(const float rows[12]);
+
+    /**
+     * @brief Returns a translation by offset.
+     */
+    static Transform translation(const Vec3 &offset);
+
+    /**
+     * @brief Returns a scaling by factors along each axis.
+     */
+    static Transform scaling(const Vec3 &factors);
+
+    /**
+     * @brief Returns a rotation about the X, then Y, then Z axis, matching Box's rotation.
+     * @param degrees The rotation angles about each axis, in degrees.
+     */
+    static Transform rotation(const Vec3 &degrees);
+
+    /**
+     * @brief Composes two transformations; the result applies other first, then this one.
+     */
+    Transform operator*(const Transform &other) const;
+
+    /**
+     * @brief Returns the inverse transformation. The linear part must be invertible.
+     */
+    Transform inverse() const;
+
+    /**
+     * @brief Returns the determinant of the linear part; zero when the transformation collapses space.
+     */
+    float determinant() const;
+
+    /**
+     * @brief Transforms a point, applying the translation.
+     */
+    Vec3 point(const Vec3 &p) const
+    {
+        return Vec3(m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+                    m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+                    m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]);
+    }
+
+    /**
+     * @brief Transforms a direction, ignoring the translation. Lengths are not preserved.
+     */
+    Vec3 vector(const Vec3 &v) const
+    {
+        return Vec3(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                    m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                    m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+    }
+
+    /**
+     * @brief Multiplies a vector by the transpose of the linear part. Called on the inverse of a transformation,
+     *        this carries surface normals through the transformation itself.
+     */
+    Vec3 transposed_vector(const Vec3 &v) const
+    {
+        return Vec3(m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z,
+                    m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+                    m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z);
+    }
+
+private:
+    float m[3][4]; ///< Rows of the matrix; column 3 is the translation.
+};
+
+#endif // TRANSFORM_H
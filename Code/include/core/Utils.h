@@ -2,13 +2,56 @@
 #define UTILS_H
 
 #include "core/Vec3.h"
+#include "core/PCG32.h"
+#include "scene/SceneConfig.h"
+
+#include <cstdint>
+
+/**
+ * Returns the calling thread's random number generator.
+ * Every thread owns a separate PCG32 stream, so drawing numbers never contends with other threads.
+ * @return The thread-local generator
+ */
+PCG32 &thread_rng();
+
+/**
+ * Selects the sampler the calling thread draws from. Keeps the current one if it already has this type.
+ * @param type Sample generation strategy
+ */
+void set_thread_sampler(SamplerType type);
+
+/**
+ * Starts a new camera sample on the calling thread. Random numbers are a pure function of
+ * (seed, pixel, sample, bounce, dimension), so an image does not depend on the number of threads,
+ * the schedule, or how many samples neighbouring pixels took.
+ * The camera ray draws from bounce 0 until begin_bounce() is called.
+ * @param seed Render seed, changes every stream at once
+ * @param pixel_index Index of the pixel, y * width + x
+ * @param sample_index Index of the sample within the pixel
+ */
+void begin_sample(uint32_t seed, uint64_t pixel_index, uint32_t sample_index);
+
+/**
+ * Switches the calling thread's generator to the stream of a bounce of the current sample.
+ * Later random numbers are the dimensions of that bounce, in the order they are drawn.
+ * @param bounce Path vertex index, 1 for the first surface hit
+ */
+void begin_bounce(uint32_t bounce);
 
 /**
- * Generate a random float between 0 and 1 using mt19937 generator.
- * @return Random float in [0,1]
+ * Generate the next sample value between 0 and 1 from the thread's sampler.
+ * @return Random float in [0,1)
  */
 float random_float();
 
+/**
+ * Generate the next 2D sample from the thread's sampler. Use this for values that are mapped together,
+ * such as a direction or a point on a disk, so low-discrepancy samplers can stratify them jointly.
+ * @param u1 Receives the first value in [0,1)
+ * @param u2 Receives the second value in [0,1)
+ */
+void random_float2(float &u1, float &u2);
+
 /**
  * Generate a random float between min and max.
  * @param min Minimum value
@@ -43,7 +86,7 @@ Vec3 refract(const Vec3 &v, const Vec3 &n, float eta);
 float schlick(float cosine, float ref_idx);
 
 /**
- * Generate random point inside unit sphere using rejection sampling.
+ * Generate random point inside unit sphere.
  * @return Random point inside unit sphere
  */
 Vec3 random_point_in_unit_sphere();
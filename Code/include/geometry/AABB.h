@@ -34,6 +34,29 @@ public:
      */
     bool hit(const Ray &ray, float t_min, float t_max) const;
 
+    /**
+     * @brief Slab test against a ray whose inverse direction has already been computed.
+     *        Used by the BVH traversal loops so the three divisions are paid once per ray
+     *        instead of once per node.
+     *
+     * @param origin The ray origin.
+     * @param inv_direction Component-wise reciprocal of the ray direction.
+     * @param t_min Minimum t-value of the ray interval to consider.
+     * @param t_max Maximum t-value of the ray interval to consider.
+     * @return True if the ray intersects the bounding box within the specified interval, false otherwise.
+     */
+    bool hit(const Vec3 &origin, const Vec3 &inv_direction, float t_min, float t_max) const;
+
+    /**
+     * @brief Returns the centre point of the bounding box.
+     */
+    Vec3 centroid() const;
+
+    /**
+     * @brief Returns the surface area of the bounding box.
+     */
+    float surface_area() const;
+
     /**
      * @brief Creates a bounding box that surrounds two given bounding boxes.
      *
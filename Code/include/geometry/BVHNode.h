@@ -16,12 +16,11 @@ class BVHNode : public Hittable
 {
 public:
     /**
-     * @brief Constructs a BVHNode with a list of hittable objects, subdividing the objects into left and right nodes.
+     * @brief Constructs a BVH over a list of hittable objects.
+     *        The list is copied once and then sorted in place by every level of the recursion.
      * @param objects The list of hittable objects to divide.
-     * @param start The starting index in the list of objects.
-     * @param end The ending index in the list of objects.
      */
-    BVHNode(const std::vector<std::shared_ptr<Hittable>> &objects, size_t start, size_t end);
+    explicit BVHNode(const std::vector<std::shared_ptr<Hittable>> &objects);
 
     /**
      * @brief Checks if a ray intersects with the objects within this BVHNode.
@@ -33,6 +32,15 @@ public:
      */
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
 
+    /**
+     * @brief Checks whether a ray intersects the objects within this BVHNode anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
     /**
      * @brief Computes the bounding box of this BVHNode.
      * @param output_box The AABB to store the bounding box.
@@ -41,6 +49,23 @@ public:
     virtual bool bounding_box(AABB &output_box) const override;
 
 private:
+    /**
+     * @brief Constructs a BVHNode over objects[start, end), subdividing the objects into left and right nodes.
+     *        The range is reordered in place, so no level of the recursion copies the list.
+     * @param objects The list of hittable objects to divide.
+     * @param start The starting index in the list of objects.
+     * @param end The ending index in the list of objects.
+     */
+    BVHNode(std::vector<std::shared_ptr<Hittable>> &objects, size_t start, size_t end);
+
+    /**
+     * @brief Splits objects[start, end) between the left and right children and computes the node's bounds.
+     * @param objects The list of hittable objects to divide, reordered in place.
+     * @param start The starting index in the list of objects.
+     * @param end The ending index in the list of objects.
+     */
+    void build(std::vector<std::shared_ptr<Hittable>> &objects, size_t start, size_t end);
+
     std::shared_ptr<Hittable> left;  ///< Left child node containing a sublist of objects.
     std::shared_ptr<Hittable> right; ///< Right child node containing a sublist of objects.
     AABB box;                        ///< The bounding box of the node that contains both child nodes.
@@ -52,8 +77,8 @@ private:
      * @param axis The axis (0: x-axis, 1: y-axis, 2: z-axis) to compare along.
      * @return True if the bounding box of object a is smaller than that of object b along the given axis, false otherwise.
      */
-    static bool box_compare(const std::shared_ptr<Hittable> a,
-                            const std::shared_ptr<Hittable> b, int axis);
+    static bool box_compare(const std::shared_ptr<Hittable> &a,
+                            const std::shared_ptr<Hittable> &b, int axis);
 
     /**
      * @brief Compares two hittable objects based on their bounding boxes along the x-axis.
@@ -61,8 +86,8 @@ private:
      * @param b The second hittable object.
      * @return True if the bounding box of object a is smaller than that of object b along the x-axis, false otherwise.
      */
-    static bool box_x_compare(const std::shared_ptr<Hittable> a,
-                              const std::shared_ptr<Hittable> b);
+    static bool box_x_compare(const std::shared_ptr<Hittable> &a,
+                              const std::shared_ptr<Hittable> &b);
 
     /**
      * @brief Compares two hittable objects based on their bounding boxes along the y-axis.
@@ -70,8 +95,8 @@ private:
      * @param b The second hittable object.
      * @return True if the bounding box of object a is smaller than that of object b along the y-axis, false otherwise.
      */
-    static bool box_y_compare(const std::shared_ptr<Hittable> a,
-                              const std::shared_ptr<Hittable> b);
+    static bool box_y_compare(const std::shared_ptr<Hittable> &a,
+                              const std::shared_ptr<Hittable> &b);
 
     /**
      * @brief Compares two hittable objects based on their bounding boxes along the z-axis.
@@ -79,8 +104,8 @@ private:
      * @param b The second hittable object.
      * @return True if the bounding box of object a is smaller than that of object b along the z-axis, false otherwise.
      */
-    static bool box_z_compare(const std::shared_ptr<Hittable> a,
-                              const std::shared_ptr<Hittable> b);
+    static bool box_z_compare(const std::shared_ptr<Hittable> &a,
+                              const std::shared_ptr<Hittable> &b);
 };
 
 #endif
@@ -1,15 +1,13 @@
 #ifndef BOX_H
 #define BOX_H
 
+#include "core/Transform.h"
 #include "geometry/Hittable.h"
-#include "geometry/Triangle.h"
-#include <memory>
-#include <vector>
 
 /**
  * @class Box
- * @brief Represents an axis-aligned box, used for ray tracing.
- *        The box can be rotated and intersected with rays, as well as calculate its bounding box.
+ * @brief Represents a box, axis-aligned in its own frame and rotated about the origin into the scene.
+ *        Rays are carried into the box's frame and intersected with its three pairs of faces (the slab test).
  */
 class Box : public Hittable
 {
@@ -19,12 +17,12 @@ public:
      * @param min The minimum corner of the box.
      * @param max The maximum corner of the box.
      * @param rotation_deg The rotation of the box in degrees along each axis.
-     * @param mat The material associated with the box.
+     * @param mat Index of the box's material in the scene's material table.
      */
-    Box(const Vec3 &min, const Vec3 &max, const Vec3 &rotation_deg, std::shared_ptr<Material> mat);
+    Box(const Vec3 &min, const Vec3 &max, const Vec3 &rotation_deg, uint32_t mat);
 
     /**
-     * @brief Checks if a ray intersects with the box.
+     * @brief Checks if a ray intersects with the box. The face that was hit is stored in rec.hit_u.
      * @param ray The ray to test for intersection.
      * @param t_min The minimum distance for intersection.
      * @param t_max The maximum distance for intersection.
@@ -34,25 +32,48 @@ public:
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
 
     /**
-     * @brief Calculates the bounding box of the box.
+     * @brief Completes a hit record produced by hit() with the hit point, the outward normal of the face that was
+     *        hit and, for textured materials, coordinates spanning that face from 0 to 1.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials.
+     */
+    virtual void compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const override;
+
+    /**
+     * @brief Checks whether a ray intersects the box anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
+    /**
+     * @brief Calculates the bounding box around the rotated corners of the box.
      * @param output_box The AABB to store the bounding box.
      * @return True if the bounding box is successfully calculated, false otherwise.
      */
     virtual bool bounding_box(AABB &output_box) const override;
 
 private:
-    Vec3 min;                                         ///< The minimum corner of the box.
-    Vec3 max;                                         ///< The maximum corner of the box.
-    Vec3 rotation;                                    ///< The rotation of the box in degrees along each axis.
-    std::vector<std::shared_ptr<Triangle>> triangles; ///< List of triangles that make up the box.
-    std::shared_ptr<Material> material_ptr;           ///< The material associated with the box.
-
     /**
-     * @brief Rotates a given point by the box's rotation.
-     * @param point The point to rotate.
-     * @return The rotated point.
+     * @brief Finds the closest intersection of a ray with the box's faces within the interval.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @param t Receives the distance to the intersection.
+     * @param face Receives the face that was hit: 0 to 2 for the minimum faces along X, Y and Z, 3 to 5 for the
+     *        maximum faces.
+     * @return True if the ray intersects the box within the interval, false otherwise.
      */
-    Vec3 rotatePoint(const Vec3 &point) const;
+    bool intersect(const Ray &ray, float t_min, float t_max, float &t, int &face) const;
+
+    Vec3 min;               ///< The minimum corner of the box, in its own frame.
+    Vec3 max;               ///< The maximum corner of the box, in its own frame.
+    Transform box_to_world; ///< The box's rotation.
+    Transform world_to_box; ///< The inverse rotation, carrying rays into the box's frame.
+    uint32_t material_id;   ///< Index of the box's material in the scene's material table.
 };
 
 #endif // BOX_H
@@ -23,10 +23,10 @@ public:
      * @param axis The axis of the cylinder, indicating the direction of its height.
      * @param r The radius of the cylinder.
      * @param h The height of the cylinder.
-     * @param mat The material associated with the cylinder.
+     * @param mat Index of the cylinder's material in the scene's material table.
      */
-    Cylinder(const Vec3 &base, const Vec3 &axis, float r, float h, std::shared_ptr<Material> mat)
-        : center(base), axis(axis.normalized()), radius(r), height(h), material_ptr(mat) {}
+    Cylinder(const Vec3 &base, const Vec3 &axis, float r, float h, uint32_t mat)
+        : center(base), axis(axis.normalized()), radius(r), height(h), material_id(mat) {}
 
     /**
      * @brief Checks if a ray intersects with the cylinder.
@@ -38,6 +38,23 @@ public:
      */
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
 
+    /**
+     * @brief Completes a hit record produced by hit() with the hit point, the normal of the side or cap that was hit and, for textured materials, its texture coordinates.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials.
+     */
+    virtual void compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const override;
+
+    /**
+     * @brief Checks whether a ray intersects the cylinder anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
     /**
      * @brief Computes the bounding box of the cylinder.
      * @param output_box The AABB to store the bounding box.
@@ -50,7 +67,7 @@ private:
     Vec3 axis;                              ///< The direction axis of the cylinder (normalized).
     float radius;                           ///< The radius of the cylinder.
     float height;                           ///< The height of the cylinder.
-    std::shared_ptr<Material> material_ptr; ///< The material associated with the cylinder.
+    uint32_t material_id;                   ///< Index of the cylinder's material in the scene's material table.
 };
 
 #endif // CYLINDER_H
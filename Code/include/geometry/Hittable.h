@@ -4,6 +4,7 @@
 #include "core/Ray.h"
 #include "lighting/HitRecord.h"
 #include "geometry/AABB.h"
+#include "materials/MaterialTable.h"
 
 /**
  * @class Hittable
@@ -21,6 +22,9 @@ public:
 
     /**
      * @brief Pure virtual function to check if a ray intersects with the object.
+     *        Only the distance, the primitive that was hit and its hit parameters are recorded, since the
+     *        hit may still be replaced by a closer one; call compute_interaction() on rec.primitive to
+     *        complete the record of the closest hit.
      * @param ray The ray to test for intersection.
      * @param t_min The minimum distance for intersection.
      * @param t_max The maximum distance for intersection.
@@ -29,12 +33,47 @@ public:
      */
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const = 0;
 
+    /**
+     * @brief Completes a hit record filled in by this primitive's hit(): point, normal, facing and material,
+     *        and texture coordinates if the material uses them. Objects that only contain other objects
+     *        never appear as rec.primitive and keep this empty default.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials, used to decide whether texture coordinates are needed.
+     */
+    virtual void compute_interaction([[maybe_unused]] const Ray &ray,
+                                     [[maybe_unused]] HitRecord &rec,
+                                     [[maybe_unused]] const MaterialTable &materials) const {}
+
+    /**
+     * @brief Pure virtual function to check if anything along a ray blocks it, as needed by shadow rays.
+     *        Implementations return on the first intersection found and skip the normal, texture
+     *        coordinates and material that hit() fills in.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if the ray intersects the object anywhere within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const = 0;
+
     /**
      * @brief Pure virtual function to compute the bounding box of the object.
      * @param output_box The AABB to store the bounding box.
      * @return True if the bounding box is successfully computed, false otherwise.
      */
     virtual bool bounding_box(AABB &output_box) const = 0;
+
+    /**
+     * @brief Reports the vertices of a primitive that is a single triangle, so that hierarchies can copy it into
+     *        the triangle packets of their leaves. The barycentric coordinates of v1 and v2 at a hit must be what
+     *        hit() records in rec.hit_u and rec.hit_v. Other objects keep this default.
+     * @param v0 Receives the first vertex.
+     * @param v1 Receives the second vertex.
+     * @param v2 Receives the third vertex.
+     * @return True if the object is a triangle, false otherwise.
+     */
+    virtual bool triangle_vertices([[maybe_unused]] Vec3 &v0, [[maybe_unused]] Vec3 &v1,
+                                   [[maybe_unused]] Vec3 &v2) const { return false; }
 };
 
 #endif // HITTABLE_H
@@ -45,6 +45,15 @@ public:
      */
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
 
+    /**
+     * @brief Checks whether a ray intersects any object in the list anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
     /**
      * @brief Computes the bounding box of all the objects in the list.
      * @param output_box The AABB to store the bounding box of the list.
@@ -0,0 +1,80 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include "core/Transform.h"
+#include "geometry/Hittable.h"
+
+#include <memory>
+
+/**
+ * @class Instance
+ * @brief A placement of shared geometry, the prototype, under an affine transformation. The prototype is usually
+ *        a bottom-level BVH over the prototype's objects, and the scene's BVH is built over instances, so many
+ *        copies of an object cost one Instance each instead of a copy of every primitive.
+ *        Rays are carried into the prototype's space rather than normalised, so distances along them are the
+ *        same in both spaces and hits can be compared with those of other objects directly.
+ */
+class Instance : public Hittable
+{
+public:
+    /**
+     * @brief Places a prototype in the scene.
+     * @param prototype The shared geometry, in its own object space. It must not contain instances.
+     * @param object_to_world The transformation from the prototype's space to the scene's; it must be invertible.
+     */
+    Instance(std::shared_ptr<const Hittable> prototype, const Transform &object_to_world);
+
+    /**
+     * @brief Intersects the prototype with the ray carried into its space. On a hit, rec.primitive is this
+     *        instance and rec.instanced_primitive the primitive hit within the prototype.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @param rec A reference to a HitRecord that will store information about the intersection.
+     * @return True if the ray intersects the prototype, false otherwise.
+     */
+    virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
+
+    /**
+     * @brief Completes the record with the instanced primitive's interaction, then carries the point and normal
+     *        back into the scene's space. The normal keeps its facing, since the transformation preserves the sign
+     *        of its dot product with the ray direction.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials.
+     */
+    virtual void compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const override;
+
+    /**
+     * @brief Checks whether the prototype blocks the ray anywhere in the interval.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
+    /**
+     * @brief Returns the box around the transformed corners of the prototype's bounding box.
+     * @param output_box The AABB to store the bounding box.
+     * @return True if the prototype has a bounding box, false otherwise.
+     */
+    virtual bool bounding_box(AABB &output_box) const override;
+
+private:
+    /**
+     * @brief Returns the ray carried into the prototype's space.
+     */
+    Ray to_object(const Ray &ray) const
+    {
+        return Ray(world_to_object.point(ray.origin()), world_to_object.vector(ray.direction()));
+    }
+
+    std::shared_ptr<const Hittable> prototype; ///< The shared geometry, in object space.
+    Transform object_to_world;                 ///< Carries the prototype into the scene.
+    Transform world_to_object;                 ///< Carries rays into the prototype's space.
+    AABB world_bounds;                         ///< Bounds of the placed prototype.
+    bool bounded;                              ///< Whether the prototype has a bounding box.
+};
+
+#endif // INSTANCE_H
@@ -0,0 +1,230 @@
+#ifndef LINEAR_BVH_H
+#define LINEAR_BVH_H
+
+#include "geometry/Hittable.h"
+#include "geometry/AABB.h"
+#include "geometry/TrianglePacket.h"
+#include "scene/SceneConfig.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @struct LinearBVHNode
+ * @brief A compact BVH node stored in a contiguous array.
+ *        Interior nodes keep their first child directly after themselves in the array and
+ *        store the offset of the second child; leaf nodes store a range into the ordered primitive list.
+ */
+struct alignas(32) LinearBVHNode
+{
+    AABB bounds; ///< Bounds of everything below this node.
+    union
+    {
+        int32_t primitives_offset;   ///< Leaf: index of the first primitive.
+        int32_t second_child_offset; ///< Interior: index of the second child node.
+    };
+    uint16_t n_primitives; ///< Number of primitives in a leaf, 0 for interior nodes.
+    uint8_t axis;          ///< Split axis of an interior node, used to order traversal.
+    uint8_t pad[1];        ///< Pads the node out to 32 bytes.
+};
+
+/**
+ * @class LinearBVH
+ * @brief A Bounding Volume Hierarchy flattened into a single array of nodes.
+ *        Unlike BVHNode, traversal is a loop over an explicit stack rather than recursive
+ *        virtual calls, and children are visited nearest-first along the split axis.
+ *        Leaves made only of triangles are tested with the SIMD kernel of their LeafPackets.
+ */
+class LinearBVH : public Hittable
+{
+public:
+    /**
+     * @brief Builds a BVH over the given objects.
+     * @param objects The hittable objects to place in the hierarchy.
+     * @param builder The construction strategy: object median, binned SAH, or Morton-code LBVH/HLBVH.
+     *                Large subtrees are built in parallel OpenMP tasks by every strategy.
+     * @param max_prims_in_node The largest number of primitives stored in a single leaf.
+     */
+    LinearBVH(const std::vector<std::shared_ptr<Hittable>> &objects,
+              BVHBuilder builder = BVHBuilder::SAH,
+              int max_prims_in_node = 4);
+
+    /**
+     * @brief Adopts a hierarchy built earlier, such as one mapped from a scene file, without copying its nodes.
+     *        The caller is responsible for having validated the nodes against the objects.
+     * @param objects The objects the hierarchy was built over, in their original order.
+     * @param nodes The flattened nodes, laid out as by the building constructor.
+     * @param node_count The number of nodes.
+     * @param primitive_order For each leaf slot, the index of its object in objects.
+     * @param storage Keeps the memory behind nodes alive.
+     */
+    LinearBVH(const std::vector<std::shared_ptr<Hittable>> &objects,
+              const LinearBVHNode *nodes, size_t node_count, const uint32_t *primitive_order,
+              std::shared_ptr<const void> storage);
+
+    /**
+     * @brief Checks if a ray intersects with any object in the hierarchy.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @param rec A reference to a HitRecord that will store information about the closest intersection.
+     * @return True if the ray intersects any object, false otherwise.
+     */
+    virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
+
+    /**
+     * @brief Checks whether a ray intersects any object in the hierarchy anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
+    /**
+     * @brief Computes the bounding box of the whole hierarchy.
+     * @param output_box The AABB to store the bounding box.
+     * @return True if the hierarchy contains any objects, false otherwise.
+     */
+    virtual bool bounding_box(AABB &output_box) const override;
+
+    /**
+     * @brief Returns the number of nodes in the flattened hierarchy.
+     */
+    size_t node_count() const { return n_nodes; }
+
+    /**
+     * @brief Returns the flattened nodes, used to collapse this hierarchy into a wider one or to save it.
+     */
+    const LinearBVHNode *flattened_nodes() const { return nodes; }
+
+    /**
+     * @brief Returns the objects in the order referenced by the leaf nodes.
+     */
+    const std::vector<std::shared_ptr<Hittable>> &ordered_primitives() const { return primitives; }
+
+    /**
+     * @brief Estimates the expected cost of tracing a random ray through the hierarchy using the
+     *        surface area heuristic, relative to the cost of one primitive intersection.
+     */
+    float sah_cost() const;
+
+    /**
+     * @brief Moves the copied leaf triangles out of the hierarchy, for a wider hierarchy collapsed from
+     *        this one, whose leaves are the same. This hierarchy then tests every primitive on its own.
+     */
+    LeafPackets take_leaf_packets() { return std::move(packets); }
+
+    static constexpr int kSAHBins = 16;              ///< Number of centroid bins evaluated per axis.
+    static constexpr float kTraversalCost = 0.125f;  ///< Cost of visiting a node relative to a primitive test.
+    static constexpr float kIntersectionCost = 1.0f; ///< Cost of a single primitive intersection test.
+    static constexpr int kMaxDepth = 128;            ///< Deepest tree the traversal stacks hold; builds stay below it.
+
+private:
+    /**
+     * @struct BuildPrimitive
+     * @brief Per-object data cached during construction so bounding boxes are queried only once.
+     */
+    struct BuildPrimitive
+    {
+        AABB bounds;  ///< Bounds of the object.
+        Vec3 centroid; ///< Centre of the object's bounds.
+        size_t index;  ///< Index of the object in the input list.
+    };
+
+    struct BuildNode;
+    struct BuildContext;
+
+    /**
+     * @brief Builds the subtree over ctx.prims[start, end) top-down with the median or SAH splitter.
+     *        From kMaxDepth / 2 down every builder splits at the median, so the tree stays within kMaxDepth.
+     *        Large child ranges are built as separate OpenMP tasks.
+     * @param ctx The shared build state.
+     * @param node_index The pool node that receives this subtree's root.
+     * @param start The first primitive of the range.
+     * @param end One past the last primitive of the range.
+     * @param depth The depth of node_index in the tree, 0 at the root.
+     */
+    void build_top_down(BuildContext &ctx, int node_index, size_t start, size_t end, int depth);
+
+    /**
+     * @brief Sorts the primitives by the Morton code of their centroids and builds an LBVH over them,
+     *        or for HLBVH builds one LBVH treelet per Morton cluster and joins them with SAH.
+     * @param ctx The shared build state.
+     * @return The pool index of the root node.
+     */
+    int build_morton(BuildContext &ctx);
+
+    /**
+     * @brief Builds the subtree over a Morton-sorted range by splitting where the highest differing bit flips.
+     *        From kMaxDepth / 2 down the range is halved instead, so the tree stays within kMaxDepth.
+     * @param ctx The shared build state.
+     * @param codes Sorted Morton codes, parallel to ctx.prims.
+     * @param node_index The pool node that receives this subtree's root.
+     * @param start The first primitive of the range.
+     * @param end One past the last primitive of the range.
+     * @param bit The highest bit that may still differ within the range.
+     * @param depth The depth of node_index in the finished tree, 0 at the root.
+     * @return The bounds of the subtree.
+     */
+    AABB build_morton_range(BuildContext &ctx, const std::vector<uint64_t> &codes,
+                            int node_index, size_t start, size_t end, int bit, int depth);
+
+    /**
+     * @brief Builds the upper levels of an HLBVH over already built treelet roots using SAH. Below depth
+     *        kTreeletBits the roots are halved instead, so the at most 2^kTreeletBits roots end up no deeper
+     *        than 2 * kTreeletBits, the depth their treelets were built for.
+     * @param ctx The shared build state.
+     * @param roots Pool indices of the treelet roots, reordered in place.
+     * @param start The first root of the range.
+     * @param end One past the last root of the range.
+     * @param depth The depth of the subtree's root, 0 at the root of the whole tree.
+     * @return The pool index of the subtree's root.
+     */
+    int build_upper_sah(BuildContext &ctx, std::vector<int> &roots, size_t start, size_t end, int depth);
+
+    /**
+     * @brief Turns a pool node into a leaf over ctx.prims[start, end) if the range fits in one leaf.
+     * @return False if the range holds more primitives than a leaf can reference.
+     */
+    bool make_leaf(BuildContext &ctx, int node_index, size_t start, size_t end, const AABB &bounds) const;
+
+    /**
+     * @brief Copies the pool subtree rooted at build_index into the node array in depth-first order.
+     * @return The index of the subtree's root in the node array.
+     */
+    int flatten(const BuildContext &ctx, int build_index);
+
+    /**
+     * @brief Copies the triangles of the leaves, once the nodes and primitive order are final.
+     */
+    void pack_leaves();
+
+    /**
+     * @brief Partitions build_prims[start, end) around the cheapest binned SAH split.
+     * @param build_prims The cached primitive data.
+     * @param start The first primitive of the range.
+     * @param end One past the last primitive of the range.
+     * @param bounds The bounds of the whole range.
+     * @param centroid_bounds The bounds of the range's centroids.
+     * @param mid Receives the first primitive of the second half.
+     * @param axis Receives the chosen split axis.
+     * @param max_leaf_size The largest range that may be kept as a leaf.
+     * @return False if a leaf is cheaper than any split and the range is small enough to be one.
+     */
+    bool partition_sah(std::vector<BuildPrimitive> &build_prims, size_t start, size_t end,
+                       const AABB &bounds, const AABB &centroid_bounds, size_t &mid, int &axis,
+                       int max_leaf_size) const;
+
+    BVHBuilder builder;                                ///< Construction strategy.
+    int max_prims_in_node;                             ///< Leaf size limit.
+    std::vector<std::shared_ptr<Hittable>> primitives; ///< Objects reordered so every leaf references a contiguous range.
+    const LinearBVHNode *nodes = nullptr;              ///< Nodes in depth-first order; nodes[0] is the root.
+    size_t n_nodes = 0;                                ///< Number of nodes.
+    std::vector<LinearBVHNode> node_storage;           ///< Storage of nodes built by this object.
+    std::shared_ptr<const void> adopted_storage;       ///< Keeps adopted nodes alive.
+    LeafPackets packets;                               ///< Triangles of each leaf, packed for the SIMD kernel at build time.
+};
+
+#endif // LINEAR_BVH_H
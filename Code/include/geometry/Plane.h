@@ -21,10 +21,10 @@ public:
      * @brief Constructs a Plane with a specified point, normal vector, and material.
      * @param p The point on the plane.
      * @param n The normal vector of the plane.
-     * @param mat The material associated with the plane.
+     * @param mat Index of the plane's material in the scene's material table.
      */
-    Plane(const Vec3 &p, const Vec3 &n, std::shared_ptr<Material> mat)
-        : point(p), normal(n.normalized()), material_ptr(mat) {}
+    Plane(const Vec3 &p, const Vec3 &n, uint32_t mat)
+        : point(p), normal(n.normalized()), material_id(mat) {}
 
     /**
      * @brief Checks if a ray intersects with the plane.
@@ -37,16 +37,33 @@ public:
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
 
     /**
-     * @brief Computes the bounding box of the plane.
-     * @param output_box The AABB to store the bounding box.
-     * @return True if the bounding box is successfully computed, false otherwise.
+     * @brief Completes a hit record produced by hit() with the hit point, the plane normal.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials.
+     */
+    virtual void compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const override;
+
+    /**
+     * @brief Checks whether a ray intersects the plane anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
+    /**
+     * @brief Reports that the plane has no bounding box, since it is infinite.
+     * @param output_box Left unchanged.
+     * @return False.
      */
     virtual bool bounding_box(AABB &output_box) const override;
 
 private:
     Vec3 point;                             ///< A point on the plane.
     Vec3 normal;                            ///< The normal vector of the plane (normalized).
-    std::shared_ptr<Material> material_ptr; ///< The material associated with the plane.
+    uint32_t material_id;                   ///< Index of the plane's material in the scene's material table.
 };
 
 #endif // PLANE_H
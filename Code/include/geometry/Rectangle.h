@@ -4,63 +4,50 @@
 #include "core/Vec3.h"
 #include "core/Ray.h"
 #include "geometry/Hittable.h"
-#include "geometry/Triangle.h"
-#include <memory>
-#include <vector>
 
 /**
  * @class Rectangle
- * @brief Represents a rectangle in 3D space, defined by either four vertices or two diagonal corners.
- *        The rectangle is subdivided into two triangles for ray tracing purposes.
- *        It supports ray intersection tests and bounding box calculation.
+ * @brief Represents a rectangle, or more generally a parallelogram, in 3D space, defined by either four vertices or
+ *        two diagonal corners. It is intersected as a plane, with the hit point's coordinates along its two edges
+ *        checked against the bounds.
  */
 class Rectangle : public Hittable
 {
 public:
     /**
-     * @brief Constructs a Rectangle from four vertices, which are used to create two triangles.
+     * @brief Constructs a Rectangle from four vertices in order around its boundary. The rectangle spans v0, v1 and
+     *        v3; v2 is expected to be v1 + v3 - v0. The normal faces the side from which the vertices run
+     *        anticlockwise.
      * @param v0 The first vertex of the rectangle.
      * @param v1 The second vertex of the rectangle.
      * @param v2 The third vertex of the rectangle.
      * @param v3 The fourth vertex of the rectangle.
-     * @param mat The material associated with the rectangle.
+     * @param mat Index of the rectangle's material in the scene's material table.
      */
     Rectangle(
         const Vec3 &v0,
         const Vec3 &v1,
         const Vec3 &v2,
         const Vec3 &v3,
-        std::shared_ptr<Material> mat)
-        : material_ptr(mat)
-    {
-        // Subdivide the rectangle into two triangles
-        triangles.push_back(std::make_shared<Triangle>(v0, v1, v2, material_ptr));
-        triangles.push_back(std::make_shared<Triangle>(v0, v2, v3, material_ptr));
-    }
+        uint32_t mat);
 
     /**
-     * @brief Constructs a Rectangle from two diagonal corners (top-left and bottom-right).
+     * @brief Constructs a Rectangle from two diagonal corners (top-left and bottom-right). Its edges run along X
+     *        and from one corner's Y and Z to the other's.
      * @param topLeft The top-left corner of the rectangle.
      * @param bottomRight The bottom-right corner of the rectangle.
-     * @param mat The material associated with the rectangle.
+     * @param mat Index of the rectangle's material in the scene's material table.
      */
     Rectangle(
         const Vec3 &topLeft,
         const Vec3 &bottomRight,
-        std::shared_ptr<Material> mat)
-        : material_ptr(mat)
-    {
-        // Compute the other two corners
-        Vec3 topRight(bottomRight.x, topLeft.y, topLeft.z);
-        Vec3 bottomLeft(topLeft.x, bottomRight.y, bottomRight.z);
-
-        // Subdivide the rectangle into two triangles
-        triangles.push_back(std::make_shared<Triangle>(topLeft, bottomLeft, topRight, material_ptr));
-        triangles.push_back(std::make_shared<Triangle>(bottomLeft, bottomRight, topRight, material_ptr));
-    }
+        uint32_t mat)
+        : Rectangle(Vec3(topLeft.x, bottomRight.y, bottomRight.z), bottomRight,
+                    Vec3(bottomRight.x, topLeft.y, topLeft.z), topLeft, mat) {}
 
     /**
-     * @brief Checks if a ray intersects with the rectangle (through its triangles).
+     * @brief Checks if a ray intersects with the rectangle. The hit point's coordinates along the edges from v0,
+     *        each from 0 to 1, are stored in rec.hit_u and rec.hit_v.
      * @param ray The ray to test for intersection.
      * @param t_min The minimum distance for intersection.
      * @param t_max The maximum distance for intersection.
@@ -69,6 +56,24 @@ public:
      */
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
 
+    /**
+     * @brief Completes a hit record produced by hit() with the hit point, the normal and, for textured materials,
+     *        the coordinates along the edges from v0.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials.
+     */
+    virtual void compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const override;
+
+    /**
+     * @brief Checks whether a ray intersects the rectangle anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
     /**
      * @brief Computes the bounding box of the rectangle.
      * @param output_box The AABB to store the bounding box.
@@ -77,8 +82,25 @@ public:
     virtual bool bounding_box(AABB &output_box) const override;
 
 private:
-    std::shared_ptr<Material> material_ptr;           ///< The material associated with the rectangle.
-    std::vector<std::shared_ptr<Triangle>> triangles; ///< The two triangles that make up the rectangle.
+    /**
+     * @brief Finds where a ray crosses the rectangle within the interval.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @param t Receives the distance to the intersection.
+     * @param alpha Receives the coordinate of the hit point along edge_u, from 0 to 1.
+     * @param beta Receives the coordinate of the hit point along edge_v, from 0 to 1.
+     * @return True if the ray crosses the rectangle within the interval, false otherwise.
+     */
+    bool intersect(const Ray &ray, float t_min, float t_max, float &t, float &alpha, float &beta) const;
+
+    Vec3 corner;          ///< The vertex v0.
+    Vec3 edge_u;          ///< The edge from v0 to v1.
+    Vec3 edge_v;          ///< The edge from v0 to v3.
+    Vec3 normal;          ///< The unit normal, along edge_u x edge_v.
+    Vec3 w;               ///< edge_u x edge_v over its squared length, which projects points onto the edges.
+    float offset;         ///< The plane's distance from the origin along the normal.
+    uint32_t material_id; ///< Index of the rectangle's material in the scene's material table.
 };
 
 #endif // RECTANGLE_H
@@ -21,10 +21,10 @@ public:
      * @brief Constructs a Sphere with a specified center, radius, and material.
      * @param cen The center point of the sphere.
      * @param r The radius of the sphere.
-     * @param mat The material associated with the sphere.
+     * @param mat Index of the sphere's material in the scene's material table.
      */
-    Sphere(const Vec3 &cen, float r, std::shared_ptr<Material> mat)
-        : centre(cen), radius(r), material_ptr(mat) {}
+    Sphere(const Vec3 &cen, float r, uint32_t mat)
+        : centre(cen), radius(r), material_id(mat) {}
 
     /**
      * @brief Checks if a ray intersects with the sphere.
@@ -36,6 +36,23 @@ public:
      */
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
 
+    /**
+     * @brief Completes a hit record produced by hit() with the hit point, the surface normal and, for textured materials, the spherical texture coordinates.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials.
+     */
+    virtual void compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const override;
+
+    /**
+     * @brief Checks whether a ray intersects the sphere anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
     /**
      * @brief Computes the bounding box of the sphere.
      * @param output_box The AABB to store the bounding box.
@@ -45,7 +62,7 @@ public:
 
     Vec3 centre;                            ///< The center point of the sphere.
     float radius;                           ///< The radius of the sphere.
-    std::shared_ptr<Material> material_ptr; ///< The material associated with the sphere.
+    uint32_t material_id;                   ///< Index of the sphere's material in the scene's material table.
 };
 
 #endif // SPHERE_H
@@ -0,0 +1,72 @@
+#ifndef SPLIT_HIERARCHY_H
+#define SPLIT_HIERARCHY_H
+
+#include "geometry/Hittable.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * @class SplitHierarchy
+ * @brief A hierarchy over the bounded objects of a scene together with a short list of unbounded ones, such as
+ *        planes, that have no bounding box. Keeping unbounded objects out of the BVH keeps its boxes tight; they
+ *        are tested first, and their closest hit shortens the interval the hierarchy is traversed over.
+ */
+class SplitHierarchy : public Hittable
+{
+public:
+    /**
+     * @brief Combines a hierarchy with the unbounded objects left out of it.
+     * @param bounded The hierarchy over the bounded objects, or nullptr if there are none.
+     * @param unbounded The unbounded objects.
+     */
+    SplitHierarchy(std::shared_ptr<Hittable> bounded, std::vector<std::shared_ptr<Hittable>> unbounded)
+        : bounded(std::move(bounded)), unbounded(std::move(unbounded)) {}
+
+    /**
+     * @brief Splits objects by whether they have a bounding box, keeping their order within each list.
+     * @param objects The objects to split.
+     * @param bounded Receives the objects with a bounding box.
+     * @param unbounded Receives the objects without one.
+     */
+    static void partition(const std::vector<std::shared_ptr<Hittable>> &objects,
+                          std::vector<std::shared_ptr<Hittable>> &bounded,
+                          std::vector<std::shared_ptr<Hittable>> &unbounded);
+
+    /**
+     * @brief Finds the closest hit among the unbounded objects, then among the bounded ones before it.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @param rec A reference to a HitRecord that will store information about the intersection.
+     * @return True if the ray intersects any object, false otherwise.
+     */
+    virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
+
+    /**
+     * @brief Checks whether any object blocks the ray in the interval, unbounded objects first.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
+    /**
+     * @brief Returns the bounds of the hierarchy when there are no unbounded objects.
+     * @param output_box The AABB to store the bounding box.
+     * @return False if any object is unbounded, true otherwise.
+     */
+    virtual bool bounding_box(AABB &output_box) const override;
+
+    /**
+     * @brief Returns the hierarchy over the bounded objects, or nullptr if there are none.
+     */
+    const std::shared_ptr<Hittable> &bounded_hierarchy() const { return bounded; }
+
+private:
+    std::shared_ptr<Hittable> bounded;               ///< The hierarchy over the bounded objects.
+    std::vector<std::shared_ptr<Hittable>> unbounded; ///< Objects without a bounding box.
+};
+
+#endif // SPLIT_HIERARCHY_H
@@ -22,17 +22,18 @@ public:
      * @param v0 The first vertex of the triangle.
      * @param v1 The second vertex of the triangle.
      * @param v2 The third vertex of the triangle.
-     * @param mat The material associated with the triangle.
+     * @param mat Index of the triangle's material in the scene's material table.
      */
-    Triangle(const Vec3 &v0, const Vec3 &v1, const Vec3 &v2, std::shared_ptr<Material> mat)
-        : vertex0(v0), vertex1(v1), vertex2(v2), material_ptr(mat)
+    Triangle(const Vec3 &v0, const Vec3 &v1, const Vec3 &v2, uint32_t mat)
+        : vertex0(v0), vertex1(v1), vertex2(v2), material_id(mat)
     {
         // Calculate the normal vector of the triangle by taking the cross product of two edges
         normal = (v1 - v0).cross(v2 - v0).normalized();
     }
 
     /**
-     * @brief Checks if a ray intersects with the triangle.
+     * @brief Checks if a ray intersects with the triangle, using the watertight test so that rays cannot pass
+     *        between triangles sharing an edge. The barycentric coordinates of vertex1 and vertex2 are recorded.
      * @param ray The ray to test for intersection.
      * @param t_min The minimum distance for intersection.
      * @param t_max The maximum distance for intersection.
@@ -41,6 +42,23 @@ public:
      */
     virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
 
+    /**
+     * @brief Completes a hit record produced by hit() with the hit point, the face normal and, for textured materials, the planar texture coordinates.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials.
+     */
+    virtual void compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const override;
+
+    /**
+     * @brief Checks whether a ray intersects the triangle anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
     /**
      * @brief Computes the bounding box of the triangle.
      * @param output_box The AABB to store the bounding box.
@@ -48,10 +66,25 @@ public:
      */
     virtual bool bounding_box(AABB &output_box) const override;
 
+    /**
+     * @brief Reports the triangle's vertices.
+     * @param v0 Receives the first vertex.
+     * @param v1 Receives the second vertex.
+     * @param v2 Receives the third vertex.
+     * @return True.
+     */
+    virtual bool triangle_vertices(Vec3 &v0, Vec3 &v1, Vec3 &v2) const override
+    {
+        v0 = vertex0;
+        v1 = vertex1;
+        v2 = vertex2;
+        return true;
+    }
+
 private:
     Vec3 vertex0, vertex1, vertex2;         ///< The three vertices of the triangle.
     Vec3 normal;                            ///< The normal vector of the triangle, calculated from the vertices.
-    std::shared_ptr<Material> material_ptr; ///< The material associated with the triangle.
+    uint32_t material_id;                   ///< Index of the triangle's material in the scene's material table.
 };
 
 #endif // TRIANGLE_H
@@ -0,0 +1,137 @@
+#ifndef TRIANGLE_MESH_H
+#define TRIANGLE_MESH_H
+
+#include "geometry/Hittable.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+static_assert(sizeof(Vec3) == 3 * sizeof(float), "Mesh buffers are read as tightly packed Vec3 arrays");
+
+/**
+ * @struct TriangleMesh
+ * @brief An indexed triangle mesh: vertex attributes are stored once and shared by every face that uses them.
+ *        The mesh reads its buffers through plain pointers, which refer either to the owned vectors filled by a
+ *        loader or to a memory-mapped scene file kept alive by mapped_storage.
+ *        Normals and texture coordinates are optional; when present they hold one entry per position.
+ */
+struct TriangleMesh
+{
+    const Vec3 *positions = nullptr;   ///< Vertex positions.
+    const Vec3 *normals = nullptr;     ///< Per-vertex shading normals, or nullptr to use the face normal.
+    const float *uvs = nullptr;        ///< Per-vertex texture coordinates as (u, v) pairs, or nullptr.
+    const uint32_t *indices = nullptr; ///< Three position indices per face, counter-clockwise when seen from the front.
+    uint32_t vertex_count = 0;         ///< Number of entries in the vertex buffers.
+    uint32_t faces = 0;                ///< Number of faces, a third of the index count.
+    uint32_t material_id = 0;          ///< Index of the mesh's material in the scene's material table.
+
+    std::vector<Vec3> owned_positions;      ///< Position storage for meshes read from text files.
+    std::vector<Vec3> owned_normals;        ///< Normal storage for meshes read from text files.
+    std::vector<float> owned_uvs;           ///< Texture coordinate storage for meshes read from text files.
+    std::vector<uint32_t> owned_indices;    ///< Index storage for meshes read from text files.
+    std::shared_ptr<const void> mapped_storage; ///< Keeps mapped buffers alive when the mesh refers into a file.
+
+    /**
+     * @brief Points the buffers at the owned vectors, after a loader has filled them.
+     *        Empty normal or texture coordinate vectors leave those attributes absent.
+     */
+    void use_owned_buffers();
+
+    /**
+     * @brief Returns the number of faces in the mesh.
+     */
+    size_t face_count() const { return faces; }
+
+    /**
+     * @brief Returns the number of bytes held by the shared vertex and index buffers.
+     */
+    size_t buffer_bytes() const
+    {
+        return vertex_count * (sizeof(Vec3) + (normals ? sizeof(Vec3) : 0) + (uvs ? 2 * sizeof(float) : 0)) +
+               faces * 3 * sizeof(uint32_t);
+    }
+
+    /**
+     * @brief Appends one MeshTriangle per face to an object list, for inserting the mesh into a BVH.
+     *        The faces are allocated as one block that all of their shared pointers own together.
+     * @param mesh The mesh to reference. It must outlive the faces; scenes keep their meshes in Scene::meshes.
+     * @param objects The list to append the faces to.
+     */
+    static void create_faces(const TriangleMesh &mesh, std::vector<std::shared_ptr<Hittable>> &objects);
+};
+
+/**
+ * @class MeshTriangle
+ * @brief A single face of a TriangleMesh: a mesh pointer and a face index.
+ *        The vertices are read from the mesh's shared buffers on every intersection, so a face costs only
+ *        this reference rather than its own copy of the vertices and normal.
+ */
+class MeshTriangle : public Hittable
+{
+public:
+    /**
+     * @brief Constructs a reference to one face of a mesh.
+     * @param mesh The mesh the face belongs to.
+     * @param face The index of the face within the mesh.
+     */
+    MeshTriangle(const TriangleMesh *mesh, uint32_t face) : mesh(mesh), face(face) {}
+
+    /**
+     * @brief Checks if a ray intersects with the face using the watertight test, recording its barycentric
+     *        coordinates.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @param rec A reference to a HitRecord that will store information about the intersection.
+     * @return True if the ray intersects the face, false otherwise.
+     */
+    virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
+
+    /**
+     * @brief Completes a hit record produced by hit() with the hit point, the interpolated vertex normal (or the
+     *        face normal if the mesh has none) and, for textured materials, the interpolated texture coordinates.
+     * @param ray The ray that produced the hit.
+     * @param rec The hit record to complete.
+     * @param materials The scene's materials.
+     */
+    virtual void compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const override;
+
+    /**
+     * @brief Checks whether a ray intersects the face anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
+    /**
+     * @brief Computes the bounding box of the face.
+     * @param output_box The AABB to store the bounding box.
+     * @return True if the bounding box is successfully computed, false otherwise.
+     */
+    virtual bool bounding_box(AABB &output_box) const override;
+
+    /**
+     * @brief Reports the face's vertices, read from the mesh's position buffer.
+     * @param v0 Receives the first vertex.
+     * @param v1 Receives the second vertex.
+     * @param v2 Receives the third vertex.
+     * @return True.
+     */
+    virtual bool triangle_vertices(Vec3 &v0, Vec3 &v1, Vec3 &v2) const override
+    {
+        const uint32_t *index = &mesh->indices[3 * face];
+        v0 = mesh->positions[index[0]];
+        v1 = mesh->positions[index[1]];
+        v2 = mesh->positions[index[2]];
+        return true;
+    }
+
+private:
+    const TriangleMesh *mesh; ///< The mesh holding the face's vertices.
+    uint32_t face;            ///< Index of the face within the mesh.
+};
+
+#endif // TRIANGLE_MESH_H
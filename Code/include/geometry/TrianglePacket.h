@@ -0,0 +1,211 @@
+#ifndef TRIANGLE_PACKET_H
+#define TRIANGLE_PACKET_H
+
+#include "geometry/Hittable.h"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct WatertightRay
+ * @brief Per-ray data for the watertight ray/triangle test of Woop, Benthin and Wald (2013).
+ *        The axes are permuted so that the direction's largest component comes last, and a shear maps the
+ *        direction onto that axis, which reduces the test to the signs of three 2D edge functions at the origin.
+ *        Two triangles sharing an edge evaluate it from the same products, so a ray through the edge cannot
+ *        pass between them.
+ */
+struct WatertightRay
+{
+    /**
+     * @brief Prepares the permutation and shear for a ray.
+     * @param ray The ray to be tested against triangles.
+     */
+    explicit WatertightRay(const Ray &ray)
+    {
+        Vec3 o = ray.origin();
+        Vec3 d = ray.direction();
+        origin[0] = o.x;
+        origin[1] = o.y;
+        origin[2] = o.z;
+        const float direction[3] = {d.x, d.y, d.z};
+
+        kz = std::fabs(d.x) > std::fabs(d.y) ? (std::fabs(d.x) > std::fabs(d.z) ? 0 : 2)
+                                               : (std::fabs(d.y) > std::fabs(d.z) ? 1 : 2);
+        kx = kz == 2 ? 0 : kz + 1;
+        ky = kx == 2 ? 0 : kx + 1;
+        // Swapping the other two axes keeps the winding, and so the sign of the edge functions, unchanged
+        if (direction[kz] < 0.0f)
+            std::swap(kx, ky);
+
+        sx = direction[kx] / direction[kz];
+        sy = direction[ky] / direction[kz];
+        sz = 1.0f / direction[kz];
+    }
+
+    float origin[3]; ///< The ray's origin.
+    int kx, ky, kz;  ///< The permuted axes; kz is the direction's dominant axis.
+    float sx, sy, sz; ///< The shear onto the kz axis and the scale of distances along it.
+};
+
+/**
+ * @brief Recomputes in double precision the edge functions of a sheared triangle that rounded to exactly 0, which
+ *        happens for rays passing just beside an edge. The products of two floats are exact in double, so a
+ *        triangle sharing the edge recomputes it with the opposite sign; the nonzero edges keep their single
+ *        precision values for the same reason, and recomputing them would break that symmetry.
+ * @param x0 The sheared x coordinate of the first vertex.
+ * @param y0 The sheared y coordinate of the first vertex.
+ * @param x1 The sheared x coordinate of the second vertex.
+ * @param y1 The sheared y coordinate of the second vertex.
+ * @param x2 The sheared x coordinate of the third vertex.
+ * @param y2 The sheared y coordinate of the third vertex.
+ * @param e0 The edge function opposite the first vertex, recomputed if it is 0.
+ * @param e1 The edge function opposite the second vertex, recomputed if it is 0.
+ * @param e2 The edge function opposite the third vertex, recomputed if it is 0.
+ */
+inline void watertight_edges_double(float x0, float y0, float x1, float y1, float x2, float y2,
+                                    float &e0, float &e1, float &e2)
+{
+    if (e0 == 0.0f)
+        e0 = static_cast<float>(static_cast<double>(x2) * y1 - static_cast<double>(y2) * x1);
+    if (e1 == 0.0f)
+        e1 = static_cast<float>(static_cast<double>(x0) * y2 - static_cast<double>(y0) * x2);
+    if (e2 == 0.0f)
+        e2 = static_cast<float>(static_cast<double>(x1) * y0 - static_cast<double>(y1) * x0);
+}
+
+/**
+ * @brief Intersects a ray with a triangle using the watertight test, without an epsilon that loses small
+ *        triangles or leaks rays through shared edges.
+ * @param ray The ray, prepared by WatertightRay.
+ * @param v0 The first vertex of the triangle.
+ * @param v1 The second vertex of the triangle.
+ * @param v2 The third vertex of the triangle.
+ * @param t_min The minimum distance for intersection.
+ * @param t_max The maximum distance for intersection.
+ * @param t Receives the distance to the intersection.
+ * @param b1 Receives the barycentric coordinate of v1.
+ * @param b2 Receives the barycentric coordinate of v2.
+ * @return True if the ray intersects the triangle within [t_min, t_max], false otherwise.
+ */
+inline bool intersect_watertight(const WatertightRay &ray, const Vec3 &v0, const Vec3 &v1, const Vec3 &v2,
+                                 float t_min, float t_max, float &t, float &b1, float &b2)
+{
+    // Vertices relative to the origin
+    const float p0[3] = {v0.x - ray.origin[0], v0.y - ray.origin[1], v0.z - ray.origin[2]};
+    const float p1[3] = {v1.x - ray.origin[0], v1.y - ray.origin[1], v1.z - ray.origin[2]};
+    const float p2[3] = {v2.x - ray.origin[0], v2.y - ray.origin[1], v2.z - ray.origin[2]};
+
+    float x0 = p0[ray.kx] - ray.sx * p0[ray.kz];
+    float y0 = p0[ray.ky] - ray.sy * p0[ray.kz];
+    float x1 = p1[ray.kx] - ray.sx * p1[ray.kz];
+    float y1 = p1[ray.ky] - ray.sy * p1[ray.kz];
+    float x2 = p2[ray.kx] - ray.sx * p2[ray.kz];
+    float y2 = p2[ray.ky] - ray.sy * p2[ray.kz];
+
+    // Each edge function is the scaled barycentric coordinate of the opposite vertex
+    float e0 = x2 * y1 - y2 * x1;
+    float e1 = x0 * y2 - y0 * x2;
+    float e2 = x1 * y0 - y1 * x0;
+    if (e0 == 0.0f || e1 == 0.0f || e2 == 0.0f)
+        watertight_edges_double(x0, y0, x1, y1, x2, y2, e0, e1, e2);
+    if ((e0 < 0.0f || e1 < 0.0f || e2 < 0.0f) && (e0 > 0.0f || e1 > 0.0f || e2 > 0.0f))
+        return false;
+
+    float det = e0 + e1 + e2;
+    if (det == 0.0f)
+        return false;
+
+    float inv_det = 1.0f / det;
+    t = (e0 * ray.sz * p0[ray.kz] + e1 * ray.sz * p1[ray.kz] + e2 * ray.sz * p2[ray.kz]) * inv_det;
+    if (!(t >= t_min && t <= t_max))
+        return false;
+
+    b1 = e1 * inv_det;
+    b2 = e2 * inv_det;
+    return true;
+}
+
+/**
+ * @brief Triangles per leaf packet. BVH leaves hold at most four primitives, so one SSE packet covers a leaf;
+ *        eight lanes would leave half of every AVX register empty.
+ */
+constexpr int kTrianglePacketLanes = 4;
+
+/**
+ * @struct TrianglePacket
+ * @brief The vertices of up to Lanes triangles stored structure-of-arrays, so that one SIMD register holds the
+ *        same coordinate of every triangle. Unused lanes hold NaN, which no ray can hit.
+ */
+template <int Lanes>
+struct alignas(16) TrianglePacket
+{
+    float vertices[3][3][Lanes]; ///< vertices[v][axis][lane]: coordinate axis of vertex v of the lane's triangle.
+};
+
+/**
+ * @class LeafPackets
+ * @brief The vertices of a BVH's triangles, packed into TrianglePackets leaf by leaf when the hierarchy is built
+ *        so that a leaf is tested without a virtual call, index lookup or gather per primitive. Leaves of one
+ *        triangle keep just its three vertices and use the scalar watertight test; larger ones use the SIMD kernel.
+ *        Leaves holding anything other than triangles are tested primitive by primitive.
+ */
+class LeafPackets
+{
+public:
+    /**
+     * @brief Packs the vertices of every leaf whose primitives are all triangles.
+     * @param primitives The hierarchy's primitives in leaf order.
+     * @param leaves The first primitive and primitive count of every leaf.
+     */
+    void build(const std::vector<std::shared_ptr<Hittable>> &primitives,
+               const std::vector<std::pair<int32_t, int>> &leaves);
+
+    /**
+     * @brief Finds the closest hit in a leaf.
+     * @param primitives The hierarchy's primitives in leaf order.
+     * @param first The leaf's first primitive.
+     * @param count The number of primitives in the leaf.
+     * @param ray The ray to test for intersection.
+     * @param watertight The ray, prepared for the triangle test.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @param rec A reference to a HitRecord that will store information about the intersection.
+     * @return True if the ray intersects any primitive of the leaf, false otherwise.
+     */
+    bool hit(const std::shared_ptr<Hittable> *primitives, int32_t first, int count, const Ray &ray,
+             const WatertightRay &watertight, float t_min, float t_max, HitRecord &rec) const;
+
+    /**
+     * @brief Checks whether any primitive of a leaf blocks the ray in the interval.
+     * @param primitives The hierarchy's primitives in leaf order.
+     * @param first The leaf's first primitive.
+     * @param count The number of primitives in the leaf.
+     * @param ray The ray to test for intersection.
+     * @param watertight The ray, prepared for the triangle test.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    bool occluded(const std::shared_ptr<Hittable> *primitives, int32_t first, int count, const Ray &ray,
+                  const WatertightRay &watertight, float t_min, float t_max) const;
+
+    /**
+     * @brief Returns the number of bytes held by the packets, single triangles and the leaf index.
+     */
+    size_t memory_bytes() const
+    {
+        return packets.size() * sizeof(TrianglePacket<kTrianglePacketLanes>) + singles.size() * sizeof(Vec3) +
+               leaf_data.size() * sizeof(int32_t);
+    }
+
+private:
+    std::vector<TrianglePacket<kTrianglePacketLanes>> packets; ///< Triangles of the packed larger leaves, in leaf order.
+    std::vector<Vec3> singles;      ///< Three vertices per packed single-triangle leaf, in leaf order.
+    std::vector<int32_t> leaf_data; ///< Indexed by a leaf's first primitive: its first packet, its first vertex in
+                                    ///< singles if it holds one triangle, or -1 if it is not packed.
+};
+
+#endif // TRIANGLE_PACKET_H
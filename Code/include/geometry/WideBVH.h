@@ -0,0 +1,139 @@
+#ifndef WIDE_BVH_H
+#define WIDE_BVH_H
+
+#include "geometry/Hittable.h"
+#include "geometry/AABB.h"
+#include "geometry/LinearBVH.h"
+#include "geometry/TrianglePacket.h"
+#include "scene/SceneConfig.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @struct WideBVHNode
+ * @brief A BVH node with up to Width children whose bounds are stored structure-of-arrays,
+ *        so one SIMD register holds the same slab plane of every child.
+ *        A child with a non-zero count is a leaf referencing a primitive range; a child with a
+ *        zero count and a non-negative index is an interior node; unused slots hold an inverted
+ *        box that no ray can hit.
+ */
+template <int Width>
+struct alignas(32) WideBVHNode
+{
+    float bounds[6][Width];   ///< Child bounds: rows 0-2 are the x/y/z minima, rows 3-5 the x/y/z maxima.
+    int32_t children[Width];  ///< Interior: index of the child node. Leaf: index of the first primitive.
+    uint16_t counts[Width];   ///< Number of primitives in a leaf child, 0 for interior or empty slots.
+};
+
+/**
+ * @class WideBVH
+ * @brief A 4- or 8-wide BVH collapsed from a binary LinearBVH.
+ *        Each node tests all of its children against the ray at once using SSE (Width 4) or AVX
+ *        (Width 8) when the compiler targets them, falling back to a scalar loop otherwise.
+ *        Hit children are visited nearest-first, and stacked children that start beyond the
+ *        closest hit found so far are skipped when popped. Leaves made only of triangles are
+ *        tested with the SIMD kernel of their LeafPackets.
+ */
+template <int Width>
+class WideBVH : public Hittable
+{
+    static_assert(Width == 4 || Width == 8, "WideBVH supports 4 or 8 children per node");
+
+public:
+    /**
+     * @brief Builds a binary BVH over the given objects and collapses it into a wide one.
+     * @param objects The hittable objects to place in the hierarchy.
+     * @param builder The construction strategy used for the binary BVH.
+     * @param max_prims_in_node The largest number of primitives stored in a single leaf.
+     */
+    WideBVH(const std::vector<std::shared_ptr<Hittable>> &objects,
+            BVHBuilder builder = BVHBuilder::SAH,
+            int max_prims_in_node = 4);
+
+    /**
+     * @brief Adopts a wide hierarchy built earlier, such as one mapped from a scene file, without copying its nodes.
+     *        The caller is responsible for having validated the nodes against the objects.
+     * @param objects The objects the hierarchy was built over, in their original order.
+     * @param nodes The nodes, laid out as by the building constructor.
+     * @param node_count The number of nodes.
+     * @param primitive_order For each leaf slot, the index of its object in objects.
+     * @param sah_cost The SAH cost of the binary BVH the nodes were collapsed from.
+     * @param storage Keeps the memory behind nodes alive.
+     */
+    WideBVH(const std::vector<std::shared_ptr<Hittable>> &objects,
+            const WideBVHNode<Width> *nodes, size_t node_count, const uint32_t *primitive_order,
+            float sah_cost, std::shared_ptr<const void> storage);
+
+    /**
+     * @brief Checks if a ray intersects with any object in the hierarchy.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @param rec A reference to a HitRecord that will store information about the closest intersection.
+     * @return True if the ray intersects any object, false otherwise.
+     */
+    virtual bool hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const override;
+
+    /**
+     * @brief Checks whether a ray intersects any object in the hierarchy anywhere in the interval, without computing a hit record.
+     * @param ray The ray to test for intersection.
+     * @param t_min The minimum distance for intersection.
+     * @param t_max The maximum distance for intersection.
+     * @return True if any intersection lies within [t_min, t_max], false otherwise.
+     */
+    virtual bool occluded(const Ray &ray, float t_min, float t_max) const override;
+
+    /**
+     * @brief Computes the bounding box of the whole hierarchy.
+     * @param output_box The AABB to store the bounding box.
+     * @return True if the hierarchy contains any objects, false otherwise.
+     */
+    virtual bool bounding_box(AABB &output_box) const override;
+
+    /**
+     * @brief Returns the number of nodes in the hierarchy.
+     */
+    size_t node_count() const { return n_nodes; }
+
+    /**
+     * @brief Returns the nodes in depth-first order, used to save the hierarchy.
+     */
+    const WideBVHNode<Width> *flattened_nodes() const { return nodes; }
+
+    /**
+     * @brief Returns the objects in the order referenced by the leaves.
+     */
+    const std::vector<std::shared_ptr<Hittable>> &ordered_primitives() const { return primitives; }
+
+    /**
+     * @brief Returns the SAH cost of the binary BVH this hierarchy was collapsed from.
+     */
+    float sah_cost() const { return binary_sah_cost; }
+
+private:
+    /**
+     * @brief Collapses the binary subtree rooted at binary_index into a new wide node.
+     *        The child with the largest surface area is repeatedly replaced by its two children
+     *        until the node is full or only leaves remain.
+     * @param binary The binary hierarchy being collapsed.
+     * @param binary_index Index of a node in the binary hierarchy. A leaf becomes the only child.
+     * @return The index of the new wide node.
+     */
+    int collapse(const LinearBVHNode *binary, int binary_index);
+
+    AABB root_bounds;                                  ///< Bounds of the whole hierarchy.
+    float binary_sah_cost = 0.0f;                      ///< SAH cost of the source binary BVH.
+    std::vector<std::shared_ptr<Hittable>> primitives; ///< Objects in leaf order, shared with the binary BVH's layout.
+    const WideBVHNode<Width> *nodes = nullptr;         ///< Nodes in depth-first order; nodes[0] is the root.
+    size_t n_nodes = 0;                                ///< Number of nodes.
+    std::vector<WideBVHNode<Width>> node_storage;      ///< Storage of nodes collapsed by this object.
+    std::shared_ptr<const void> adopted_storage;       ///< Keeps adopted nodes alive.
+    LeafPackets packets;                               ///< Triangles of each leaf, packed for the SIMD kernel at build time.
+};
+
+using BVH4 = WideBVH<4>;
+using BVH8 = WideBVH<8>;
+
+#endif // WIDE_BVH_H
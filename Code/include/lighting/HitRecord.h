@@ -3,9 +3,9 @@
 
 #include "core/Vec3.h"
 #include "core/Ray.h"
-#include <memory>
+#include <cstdint>
 
-class Material;
+class Hittable;
 
 // A record to store details of an intersection
 /**
@@ -13,16 +13,23 @@ class Material;
  * @brief A structure that stores the details of a ray-object intersection.
  *        This includes the intersection point, normal, material, and other relevant information
  *        such as the ray's direction and texture coordinates.
+ *        Hittable::hit() only fills in t, primitive and the hit parameters; calling compute_interaction()
+ *        on the primitive once the closest hit is known fills in the rest.
  */
 struct HitRecord
 {
-    Vec3 point;                             ///< The point of intersection where the ray hits the object.
-    Vec3 normal;                            ///< The normal vector at the point of intersection.
-    float t;                                ///< The distance along the ray to the intersection point.
-    float u;                                ///< The U texture coordinate (if available).
-    float v;                                ///< The V texture coordinate (if available).
-    bool front_face;                        ///< Indicates whether the intersection is on the front face of the object.
-    std::shared_ptr<Material> material_ptr; ///< The material associated with the intersected object.
+    Vec3 point;           ///< The point of intersection where the ray hits the object.
+    Vec3 normal;          ///< The normal vector at the point of intersection.
+    float t;              ///< The distance along the ray to the intersection point.
+    float u;              ///< The U texture coordinate (if available).
+    float v;              ///< The V texture coordinate (if available).
+    bool front_face;      ///< Indicates whether the intersection is on the front face of the object.
+    uint32_t material_id; ///< Index of the intersected object's material in the scene's MaterialTable.
+
+    const Hittable *primitive;           ///< The primitive that was hit.
+    const Hittable *instanced_primitive; ///< When primitive is an Instance, the primitive hit within its prototype.
+    float hit_u;                         ///< First primitive-specific hit parameter, e.g. a barycentric coordinate.
+    float hit_v;                         ///< Second primitive-specific hit parameter.
 
     /**
      * @brief Sets the normal for the intersection point based on the ray's direction.
@@ -2,8 +2,7 @@
 #define SCATTER_RECORD_H
 
 #include "core/Vec3.h"
-#include "materials/PDF.h"
-#include <memory>
+#include "materials/ScatterPDF.h"
 
 /**
  * @struct ScatterRecord
@@ -13,10 +12,10 @@
  */
 struct ScatterRecord
 {
-    Vec3 attenuation;             ///< The attenuation factor for the scattered ray, representing how much light is absorbed or scattered.
-    std::shared_ptr<PDF> pdf_ptr; ///< A pointer to the PDF that describes the scattering probability distribution.
-    bool specular_ray = false;    ///< Indicates if the scattered ray is specular (i.e., perfectly reflected).
-    Vec3 specular_direction;      ///< The direction of the specular ray if the ray is specular.
+    Vec3 attenuation;          ///< The attenuation factor for the scattered ray, representing how much light is absorbed or scattered.
+    ScatterPDF pdf;            ///< The PDF that describes the scattering probability distribution, held by value.
+    bool specular_ray = false; ///< Indicates if the scattered ray is specular (i.e., perfectly reflected).
+    Vec3 specular_direction;   ///< The direction of the specular ray if the ray is specular.
 };
 
 #endif // SCATTER_RECORD_H
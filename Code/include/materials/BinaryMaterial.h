@@ -25,6 +25,7 @@ public:
      * @param view_dir The direction from the point of view.
      * @param lights A list of lights in the scene.
      * @param scene The scene geometry for additional lighting interactions.
+     * @param materials The scene's materials (unused).
      * @param depth The current recursion depth for reflections or refractions (unused).
      * @param config The scene configuration for additional settings (unused).
      * @return The constant hit color for the material.
@@ -34,6 +35,7 @@ public:
         [[maybe_unused]] const Vec3 &view_dir,
         [[maybe_unused]] const std::vector<std::shared_ptr<Light>> &lights,
         [[maybe_unused]] const Hittable &scene,
+        [[maybe_unused]] const MaterialTable &materials,
         [[maybe_unused]] int depth,
         [[maybe_unused]] const SceneConfig &config) const
     {
@@ -106,6 +106,7 @@ public:
      * @param view_dir The direction from the viewpoint (camera).
      * @param lights A list of lights in the scene.
      * @param scene The scene geometry, used to check for shadows.
+     * @param materials The scene's materials, used to shade reflected and refracted hits.
      * @param depth The current recursion depth for reflections/refractions.
      * @param config The scene configuration containing additional parameters.
      * @return The color resulting from the shading calculation.
@@ -115,6 +116,7 @@ public:
         const Vec3 &view_dir,
         const std::vector<std::shared_ptr<Light>> &lights,
         const Hittable &scene,
+        const MaterialTable &materials,
         int depth,
         const SceneConfig &config) const override;
 
@@ -132,6 +134,11 @@ public:
         Vec3 &scatter_direction,
         float &pdf) const override;
 
+    /**
+     * @brief Returns true if the diffuse component is textured.
+     */
+    virtual bool uses_texture_coordinates() const override { return use_texture; }
+
 private:
     /**
      * @brief Calculates the ambient lighting contribution for the material.
@@ -176,6 +183,7 @@ private:
      * @param view_dir The view direction.
      * @param lights A list of lights in the scene.
      * @param scene The scene geometry.
+     * @param materials The scene's materials.
      * @param depth The recursion depth for reflection.
      * @param config The scene configuration.
      * @return The color of the reflected ray.
@@ -185,6 +193,7 @@ private:
         const Vec3 &view_dir,
         const std::vector<std::shared_ptr<Light>> &lights,
         const Hittable &scene,
+        const MaterialTable &materials,
         int depth,
         const SceneConfig &config) const;
 
@@ -194,6 +203,7 @@ private:
      * @param view_dir The view direction.
      * @param lights A list of lights in the scene.
      * @param scene The scene geometry.
+     * @param materials The scene's materials.
      * @param depth The recursion depth for refraction.
      * @param config The scene configuration.
      * @return The color of the refracted ray.
@@ -203,6 +213,7 @@ private:
         const Vec3 &view_dir,
         const std::vector<std::shared_ptr<Light>> &lights,
         const Hittable &scene,
+        const MaterialTable &materials,
         int depth,
         const SceneConfig &config) const;
 
@@ -9,7 +9,7 @@
  *        This is typically used for materials with Lambertian (diffuse) reflection, where the probability
  *        of a direction is proportional to the cosine of the angle between the surface normal and the direction.
  */
-class CosinePDF : public PDF
+class CosinePDF final : public PDF
 {
 public:
     /**
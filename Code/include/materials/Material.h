@@ -8,6 +8,7 @@
 #include "lighting/HitRecord.h"
 #include "geometry/HittableList.h"
 #include "lighting/ScatterRecord.h"
+#include "materials/MaterialTable.h"
 
 #include <vector>
 #include <memory>
@@ -36,6 +37,7 @@ public:
      * @param view_dir The direction from the viewpoint (camera).
      * @param lights A list of lights in the scene.
      * @param scene The scene geometry (used for shadow calculations, for example).
+     * @param materials The scene's materials, used to shade secondary hits.
      * @param depth The current recursion depth for reflections or refractions (unused).
      * @param config The scene configuration (unused).
      * @return The color resulting from the shading calculation.
@@ -45,6 +47,7 @@ public:
         [[maybe_unused]] const Vec3 &view_dir,
         [[maybe_unused]] const std::vector<std::shared_ptr<Light>> &lights,
         [[maybe_unused]] const Hittable &scene,
+        [[maybe_unused]] const MaterialTable &materials,
         [[maybe_unused]] int depth,
         [[maybe_unused]] const SceneConfig &config) const
     {
@@ -117,6 +120,15 @@ public:
     {
         return Vec3(0, 0, 0); // Default: No emission
     }
+
+    /**
+     * @brief Returns true if shading reads the texture coordinates of the hit record.
+     *        Hit records for materials that do not are completed without computing them.
+     */
+    virtual bool uses_texture_coordinates() const
+    {
+        return false; // Default: No textures
+    }
 };
 
 #endif // MATERIAL_H
@@ -0,0 +1,48 @@
+#ifndef MATERIAL_TABLE_H
+#define MATERIAL_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Material;
+
+/**
+ * @class MaterialTable
+ * @brief Scene-owned storage for every material, addressed by 32-bit material IDs.
+ *        Primitives and hit records carry only the ID, so recording a hit copies an integer instead of
+ *        a reference-counted pointer; the table keeps the materials alive for the lifetime of the scene.
+ */
+class MaterialTable
+{
+public:
+    /**
+     * @brief Adds a material to the table.
+     * @param material The material to store.
+     * @return The ID under which the material is stored.
+     */
+    uint32_t add(std::shared_ptr<Material> material);
+
+    /**
+     * @brief Returns the material stored under an ID.
+     * @param id An ID returned by add().
+     */
+    const Material &operator[](uint32_t id) const { return *materials[id]; }
+
+    /**
+     * @brief Returns true if the material stored under an ID reads texture coordinates.
+     * @param id An ID returned by add().
+     */
+    bool uses_texture_coordinates(uint32_t id) const { return texture_coordinates[id]; }
+
+    /**
+     * @brief Returns the number of materials in the table.
+     */
+    size_t size() const { return materials.size(); }
+
+private:
+    std::vector<std::shared_ptr<Material>> materials; ///< Materials indexed by ID.
+    std::vector<uint8_t> texture_coordinates;          ///< Per ID, whether the material reads texture coordinates.
+};
+
+#endif // MATERIAL_TABLE_H
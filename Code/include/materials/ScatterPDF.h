@@ -0,0 +1,72 @@
+#ifndef SCATTER_PDF_H
+#define SCATTER_PDF_H
+
+#include "materials/CosinePDF.h"
+
+#include <type_traits>
+#include <variant>
+
+/**
+ * @class ScatterPDF
+ * @brief A scattering PDF held by value: empty, or one of the PDFs that materials return.
+ *        Materials fill it on every bounce, so it is a variant of the known PDF types rather than
+ *        a pointer to a heap-allocated PDF; dispatch uses the concrete type and needs no allocation.
+ *        New PDFs that materials return are added as alternatives of the variant.
+ */
+class ScatterPDF
+{
+public:
+    /**
+     * @brief Constructs an empty ScatterPDF; the material provides no distribution to sample.
+     */
+    ScatterPDF() = default;
+
+    /**
+     * @brief Constructs a ScatterPDF holding a cosine-weighted distribution.
+     * @param pdf The distribution to hold.
+     */
+    ScatterPDF(const CosinePDF &pdf) : m_pdf(pdf) {}
+
+    /**
+     * @brief Returns true if a distribution is held.
+     */
+    explicit operator bool() const { return !std::holds_alternative<std::monostate>(m_pdf); }
+
+    /**
+     * @brief Calculates the value of the held PDF for a given direction; 0 if empty.
+     * @param direction The direction for which the PDF value is calculated.
+     * @return The PDF value for the specified direction.
+     */
+    float value(const Vec3 &direction) const
+    {
+        return std::visit([&direction](const auto &pdf) -> float
+                          {
+                              if constexpr (std::is_same_v<std::decay_t<decltype(pdf)>, std::monostate>)
+                                  return 0.0f;
+                              else
+                                  return pdf.value(direction);
+                          },
+                          m_pdf);
+    }
+
+    /**
+     * @brief Samples a direction from the held PDF. Must not be called on an empty ScatterPDF.
+     * @return A randomly generated direction based on the PDF's distribution.
+     */
+    Vec3 generate() const
+    {
+        return std::visit([](const auto &pdf) -> Vec3
+                          {
+                              if constexpr (std::is_same_v<std::decay_t<decltype(pdf)>, std::monostate>)
+                                  return Vec3(0, 0, 0);
+                              else
+                                  return pdf.generate();
+                          },
+                          m_pdf);
+    }
+
+private:
+    std::variant<std::monostate, CosinePDF> m_pdf; ///< The held distribution, if any.
+};
+
+#endif // SCATTER_PDF_H
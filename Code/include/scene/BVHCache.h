@@ -0,0 +1,70 @@
+#ifndef BVH_CACHE_H
+#define BVH_CACHE_H
+
+#include "geometry/Hittable.h"
+#include "scene/SceneConfig.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class BVHCache
+ * @brief A directory of BVHs built for earlier renders, stored as .rtbin files that hold only a hierarchy.
+ *        Every builder reads nothing but the objects' bounding boxes, so a hash of the boxes in object order
+ *        and the BVH settings identifies a hierarchy exactly: camera, material and sampling changes keep hitting
+ *        the same entry. Entries are mapped and validated like the BVH of a .rtbin scene. A hit refreshes the
+ *        entry's modification time, so the oldest entries are the least recently used ones, which store evicts
+ *        once the directory outgrows bvh_cache_max_mb.
+ */
+class BVHCache
+{
+public:
+    static constexpr size_t kMinObjects = 4096; ///< Smaller scenes build faster than an entry can be hashed and mapped.
+
+    /**
+     * @brief Hashes the bounding boxes of the objects in order, the only geometry a BVH builder reads.
+     * @param objects The scene's objects, in order.
+     * @return The hash.
+     */
+    static uint64_t bounds_key(const std::vector<std::shared_ptr<Hittable>> &objects);
+
+    /**
+     * @brief Hashes the geometry a BVH would be built over.
+     * @param objects The scene's objects, in order.
+     * @param config The configuration; its BVH width and builder are part of the key.
+     * @return The cache key.
+     */
+    static uint64_t geometry_key(const std::vector<std::shared_ptr<Hittable>> &objects, const SceneConfig &config);
+
+    /**
+     * @brief Returns the path of the entry for a key in the configured cache directory.
+     */
+    static std::string entry_path(uint64_t key, const SceneConfig &config);
+
+    /**
+     * @brief Maps the entry for a key and creates its BVH over the scene's objects, marking the entry as used.
+     * @param key The key from geometry_key.
+     * @param objects The scene's objects, in order.
+     * @param config The scene configuration.
+     * @return The hierarchy, or nullptr if there is no entry or it fails validation.
+     */
+    static std::shared_ptr<Hittable> load(uint64_t key, const std::vector<std::shared_ptr<Hittable>> &objects,
+                                          const SceneConfig &config);
+
+    /**
+     * @brief Stores a freshly built BVH under a key. The entry is written to a temporary file and renamed into
+     *        place, so other renders never map a partial file. The least recently used other entries are then
+     *        removed until the directory fits in bvh_cache_max_mb.
+     * @param key The key from geometry_key.
+     * @param root The scene's root, a LinearBVH or WideBVH.
+     * @param objects The objects the hierarchy was built over, in order.
+     * @param config The configuration the hierarchy was built with.
+     * @return The size of the entry in bytes, or 0 if it could not be stored.
+     */
+    static uint64_t store(uint64_t key, const Hittable &root, const std::vector<std::shared_ptr<Hittable>> &objects,
+                          const SceneConfig &config);
+};
+
+#endif // BVH_CACHE_H
@@ -0,0 +1,45 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include "geometry/TriangleMesh.h"
+
+#include <string>
+
+/**
+ * @class MeshLoader
+ * @brief Reads triangle meshes from Wavefront OBJ and PLY files into the shared buffers of a TriangleMesh.
+ *        Polygons are triangulated as fans. Vertex normals and texture coordinates are kept when every
+ *        vertex of the mesh has them.
+ */
+class MeshLoader
+{
+public:
+    /**
+     * @brief Loads a mesh, choosing the format from the file extension (.obj or .ply).
+     * @param filename The path of the mesh file.
+     * @param mesh The mesh to fill; its material ID is left unchanged.
+     * @return True if the file was read and contains at least one face, false otherwise.
+     */
+    static bool load(const std::string &filename, TriangleMesh &mesh);
+
+    /**
+     * @brief Loads a Wavefront OBJ file: v, vt and vn records and f records with v, v/vt, v//vn or v/vt/vn
+     *        corners, including negative (relative) indices. Groups, objects and material libraries are ignored.
+     * @param filename The path of the OBJ file.
+     * @param mesh The mesh to fill.
+     * @return True on success, false otherwise.
+     */
+    static bool load_obj(const std::string &filename, TriangleMesh &mesh);
+
+    /**
+     * @brief Loads a binary (little or big endian) PLY file: a vertex element with x, y, z and optionally nx, ny, nz
+     *        and u, v (or s, t), and a face element with a vertex_indices (or vertex_index) list. Other elements
+     *        and properties are skipped.
+     * @param filename The path of the PLY file.
+     * @param mesh The mesh to fill.
+     * @return True on success, false otherwise.
+     */
+    static bool load_ply(const std::string &filename, TriangleMesh &mesh);
+};
+
+#endif // MESH_LOADER_H
@@ -0,0 +1,94 @@
+#ifndef RENDER_CHECKPOINT_H
+#define RENDER_CHECKPOINT_H
+
+#include "core/Vec3.h"
+#include "scene/SceneConfig.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct CheckpointHeader
+ * @brief The header at the start of a checkpoint file. It identifies the scene description and every setting
+ *        that changes the value of a sample, so that a checkpoint is only resumed by a render that would have
+ *        produced the same sums. Mesh files are identified through the bounds of their triangles, textures only
+ *        by their paths in the description. The header is followed by width * height pixel sums as three floats
+ *        each, then the per-pixel sample counts as uint32s. Files are written in the producer's byte order.
+ */
+struct CheckpointHeader
+{
+    char magic[8];               ///< RenderCheckpoint::kMagic.
+    uint32_t version;            ///< RenderCheckpoint::kVersion.
+    uint32_t width;              ///< Image width in pixels.
+    uint32_t height;             ///< Image height in pixels.
+    uint32_t seed;               ///< SceneConfig::seed.
+    uint32_t sampler;            ///< SceneConfig::sampler.
+    uint32_t max_ray_depth;      ///< SceneConfig::max_ray_depth.
+    uint32_t stratified_samples; ///< Samples per stratum side when stratified sampling is on, 0 otherwise.
+    uint32_t reserved;           ///< Zero; pads the header to a multiple of 8 bytes.
+    uint64_t description_key;    ///< SceneConfig::description_key.
+    uint64_t bounds_key;         ///< BVHCache::bounds_key of the scene's objects.
+};
+
+/**
+ * @class RenderCheckpoint
+ * @brief The accumulated samples of a progressive render: the running sum and sample count of every pixel.
+ *        Saving and loading keep the float sums bit for bit, so a resumed render continues exactly where the
+ *        interrupted one stopped.
+ */
+class RenderCheckpoint
+{
+public:
+    static constexpr char kMagic[8] = {'R', 'T', 'C', 'K', 'P', 'T', '\r', '\n'}; ///< Identifies a checkpoint.
+    static constexpr uint32_t kVersion = 2;                                     ///< Current format version.
+
+    /**
+     * @brief Hashes a scene description for SceneConfig::description_key. Top-level settings that only choose
+     *        how the image is computed or post-processed (BVH, scheduling, checkpointing, denoising, tone
+     *        mapping, the sample target) are left out, so changing them still resumes the checkpoint.
+     * @param description The parsed scene description.
+     * @return The key.
+     */
+    static uint64_t description_key(const nlohmann::json &description);
+
+    /**
+     * @brief Creates an empty accumulation for a render.
+     * @param config The render's configuration, including its description_key.
+     * @param bounds_key A hash of the scene's objects, from BVHCache::bounds_key.
+     */
+    RenderCheckpoint(const SceneConfig &config, uint64_t bounds_key);
+
+    /**
+     * @brief Replaces the accumulation with the one stored in a file, if the file belongs to this render.
+     *        A missing file is not an error; a corrupt or mismatched one is reported and left alone, as is one
+     *        with more samples in some pixel than the render asks for, since they cannot be taken out of the sums.
+     * @param path The checkpoint file.
+     * @param max_samples The number of samples per pixel the render takes.
+     * @return True if the checkpoint was loaded.
+     */
+    bool load(const std::string &path, uint32_t max_samples);
+
+    /**
+     * @brief Writes the accumulation to a file. It is written to a temporary file and renamed into place, so
+     *        an interruption while saving leaves the previous checkpoint intact.
+     * @param path The checkpoint file.
+     * @return True on success.
+     */
+    bool save(const std::string &path) const;
+
+    /**
+     * @brief Returns the smallest sample count of any pixel.
+     */
+    uint32_t min_samples() const;
+
+    std::vector<Vec3> sums;        ///< The sum of every pixel's samples, indexed by y * width + x.
+    std::vector<uint32_t> counts;  ///< The number of samples summed for every pixel.
+
+private:
+    CheckpointHeader header; ///< Identifies the render the accumulation belongs to.
+};
+
+#endif // RENDER_CHECKPOINT_H
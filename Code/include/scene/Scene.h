@@ -5,7 +5,9 @@
 #include "core/Camera.h"
 #include "core/Image.h"
 #include "geometry/Hittable.h"
+#include "geometry/TriangleMesh.h"
 #include "lighting/Light.h"
+#include "materials/MaterialTable.h"
 
 #include <memory>
 #include <vector>
@@ -28,6 +30,16 @@ struct Scene
      */
     std::vector<std::shared_ptr<Light>> lights;
 
+    /**
+     * @brief The materials of the scene's objects. Objects and hit records refer to them by their index in this table.
+     */
+    MaterialTable materials;
+
+    /**
+     * @brief The triangle meshes of the scene. Their faces in the object list refer to these shared buffers.
+     */
+    std::vector<std::unique_ptr<TriangleMesh>> meshes;
+
     /**
      * @brief The root object of the scene, used for organizing the scene hierarchy. This is often the "root" of the scene graph.
      */
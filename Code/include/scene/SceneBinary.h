@@ -0,0 +1,159 @@
+#ifndef SCENE_BINARY_H
+#define SCENE_BINARY_H
+
+#include "core/MappedFile.h"
+#include "geometry/Hittable.h"
+#include "geometry/TriangleMesh.h"
+#include "scene/SceneConfig.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct RtbinHeader
+ * @brief The header at the start of a .rtbin scene file. Offsets are in bytes from the start of the file and
+ *        every section starts on a kSectionAlignment boundary, so buffers can be used in place once mapped.
+ *        Files are written in the producer's byte order and rejected by hosts with a different one.
+ */
+struct RtbinHeader
+{
+    char magic[8];               ///< kMagic.
+    uint32_t version;            ///< kVersion.
+    uint32_t byte_order;         ///< kByteOrderMark as written by the producer.
+    uint64_t file_size;          ///< Total size of the file.
+    uint64_t description_offset; ///< The scene description: camera, settings, lights, materials and shapes as JSON.
+    uint64_t description_size;   ///< Length of the description in bytes.
+    uint64_t meshes_offset;      ///< Array of mesh_count RtbinMesh records.
+    uint64_t mesh_count;         ///< Number of mesh records; "mesh" shapes refer to them by their "buffer" index.
+    uint64_t bvh_offset;         ///< An RtbinBVH record, or 0 if the file holds no prebuilt hierarchy.
+};
+
+/**
+ * @struct RtbinMesh
+ * @brief Locates the buffers of one triangle mesh. Absent attributes have an offset of 0.
+ */
+struct RtbinMesh
+{
+    uint64_t positions_offset; ///< vertex_count packed (x, y, z) floats.
+    uint64_t normals_offset;   ///< vertex_count packed (x, y, z) floats, or 0.
+    uint64_t uvs_offset;       ///< vertex_count (u, v) float pairs, or 0.
+    uint64_t indices_offset;   ///< 3 * face_count uint32 vertex indices.
+    uint32_t vertex_count;     ///< Number of vertices.
+    uint32_t face_count;       ///< Number of triangles.
+};
+
+/**
+ * @struct RtbinBVH
+ * @brief Describes a flattened BVH over a scene's object list, as built by LinearBVH (width 2) or WideBVH.
+ *        It is valid only for the object list it was built over, in the same order.
+ */
+struct RtbinBVH
+{
+    uint32_t width;                  ///< Branching factor: 2, 4 or 8.
+    uint32_t builder;                ///< The BVHBuilder that built the hierarchy.
+    uint32_t node_size;              ///< Size of one node in bytes, checked against the reader's layout.
+    float sah_cost;                  ///< SAH cost of the binary hierarchy.
+    uint64_t object_count;           ///< Number of objects the hierarchy was built over.
+    uint64_t node_count;             ///< Number of nodes.
+    uint64_t nodes_offset;           ///< The nodes, in depth-first order.
+    uint64_t primitive_order_offset; ///< object_count uint32 object indices, in leaf order.
+};
+
+/**
+ * @class SceneBinary
+ * @brief Reads and writes .rtbin scene files: a JSON scene description whose meshes live in binary buffers,
+ *        optionally followed by a prebuilt BVH. Opening a file maps it into memory and validates its layout;
+ *        meshes and the BVH then refer directly to the mapped bytes, with no parsing or copying.
+ */
+class SceneBinary
+{
+public:
+    static constexpr char kMagic[8] = {'R', 'T', 'B', 'I', 'N', '\0', '\r', '\n'}; ///< Identifies a .rtbin file.
+    static constexpr uint32_t kVersion = 1;                   ///< Current format version.
+    static constexpr uint32_t kByteOrderMark = 0x01020304u;   ///< Reads differently on a host of the other byte order.
+    static constexpr uint64_t kSectionAlignment = 64;         ///< Alignment of every section in the file.
+
+    /**
+     * @brief Maps a .rtbin file and validates its header, mesh records and BVH record.
+     * @param filename The path of the file.
+     * @return The opened file, or nullptr (after printing the reason) if it is missing or malformed.
+     */
+    static std::shared_ptr<SceneBinary> open(const std::string &filename);
+
+    /**
+     * @brief Returns the scene description, the JSON text of a scene file with "mesh" shapes referring to buffers.
+     */
+    std::string description() const;
+
+    /**
+     * @brief Returns the number of meshes in the file.
+     */
+    size_t mesh_count() const { return meshes.size(); }
+
+    /**
+     * @brief Points a mesh's buffers into the mapped file. The mesh keeps the mapping alive.
+     * @param index The index of the mesh record.
+     * @param mesh The mesh to set up; its material ID is left unchanged.
+     */
+    void attach_mesh(size_t index, TriangleMesh &mesh) const;
+
+    /**
+     * @brief Creates the file's prebuilt BVH over the scene's objects, referring to the mapped nodes.
+     * @param objects The scene's bounded objects, created from the description in file order.
+     * @param config The scene configuration; the hierarchy is used only if its width and builder match.
+     * @return The hierarchy, or nullptr if the file has none, it does not match, or it fails validation.
+     */
+    std::shared_ptr<Hittable> adopt_bvh(const std::vector<std::shared_ptr<Hittable>> &objects,
+                                        const SceneConfig &config) const;
+
+    /**
+     * @brief Converts a JSON scene, and the OBJ or PLY meshes it references, into a .rtbin file.
+     *        Mesh files, among the shapes and in prototypes, are read into binary buffers, and runs of consecutive
+     *        untextured "triangle" shapes with the same material are merged into one mesh. With with_bvh, the scene
+     *        is then loaded from the new file and the BVH it builds over its objects is appended.
+     * @param json_path The JSON scene to convert.
+     * @param rtbin_path The file to write.
+     * @param with_bvh Whether to store a prebuilt BVH.
+     * @return True on success, false otherwise.
+     */
+    static bool convert(const std::string &json_path, const std::string &rtbin_path, bool with_bvh);
+
+    /**
+     * @brief Appends an RtbinBVH record and its arrays for a BVH built by SceneLoader to a file stream.
+     * @param out The stream, positioned at the end of the file; its position is the file offset.
+     * @param root The scene's root: a LinearBVH or WideBVH, or a SplitHierarchy whose bounded objects have one.
+     * @param objects The objects the hierarchy was built over, in their original order.
+     * @param config The configuration the hierarchy was built with.
+     * @return The file offset of the record, or 0 if root is not a BVH.
+     */
+    static uint64_t write_bvh(std::ostream &out, const Hittable &root,
+                              const std::vector<std::shared_ptr<Hittable>> &objects, const SceneConfig &config);
+
+    /**
+     * @brief Writes a .rtbin file that holds only a description and a BVH, with no meshes.
+     * @param path The file to write.
+     * @param description The description to store, identifying what the hierarchy was built over.
+     * @param root The scene's root, a LinearBVH or WideBVH.
+     * @param objects The objects the hierarchy was built over, in their original order.
+     * @param config The configuration the hierarchy was built with.
+     * @return The size of the file in bytes, or 0 if root is not a BVH or the file could not be written.
+     */
+    static uint64_t write_bvh_file(const std::string &path, const std::string &description, const Hittable &root,
+                                   const std::vector<std::shared_ptr<Hittable>> &objects, const SceneConfig &config);
+
+private:
+    /**
+     * @brief Checks that [offset, offset + size) lies within the file and offset is suitably aligned.
+     */
+    bool in_bounds(uint64_t offset, uint64_t size, uint64_t alignment) const;
+
+    std::shared_ptr<MappedFile> file; ///< The mapped file.
+    const RtbinHeader *header = nullptr; ///< The file's header.
+    std::vector<RtbinMesh> meshes;    ///< Validated mesh records.
+    const RtbinBVH *bvh = nullptr;    ///< The BVH record, or nullptr.
+};
+
+#endif // SCENE_BINARY_H
@@ -3,6 +3,9 @@
 
 #include "core/Vec3.h"
 
+#include <cstdint>
+#include <string>
+
 /**
  * @enum RenderMode
  * @brief An enumeration of different rendering modes supported by the renderer.
@@ -17,6 +20,44 @@ enum class RenderMode
     PATH,
 };
 
+/**
+ * @enum BVHBuilder
+ * @brief The strategy used to build the BVH.
+ *        LBVH splits primitives sorted by the Morton code of their centroids; HLBVH builds
+ *        LBVH treelets and joins them with SAH. Both trade some tree quality for build speed.
+ */
+enum class BVHBuilder
+{
+    MEDIAN,
+    SAH,
+    LBVH,
+    HLBVH,
+};
+
+/**
+ * @enum SamplerType
+ * @brief The source of sample values for pixel jitter, lens, BRDF and light sampling.
+ *        SOBOL and HALTON are randomized low-discrepancy sequences that converge faster than RANDOM.
+ */
+enum class SamplerType
+{
+    RANDOM,
+    SOBOL,
+    HALTON,
+};
+
+/**
+ * @enum RenderScheduler
+ * @brief How the pixels of an image are shared out between threads.
+ *        SCANLINES hands out whole rows; TILES hands out square tiles in Morton order with work stealing,
+ *        which keeps each thread on a compact region of the screen and of the scene.
+ */
+enum class RenderScheduler
+{
+    SCANLINES,
+    TILES,
+};
+
 /**
  * @struct SceneConfig
  * @brief A structure to hold configuration settings for rendering a scene.
@@ -76,7 +117,7 @@ struct SceneConfig
 
     // Importance sampling settings
     /**
-     * @brief Whether to use importance sampling in the rendering process.
+     * @brief Whether to choose each tile's sample count adaptively, from the variance of its pixels' samples.
      */
     bool use_importance_sampling{false};
     /**
@@ -88,9 +129,17 @@ struct SceneConfig
      */
     int max_samples{64};
     /**
-     * @brief The threshold for determining importance in sampling.
+     * @brief The relative error of a tile's displayed luminance below which its pixels stop taking samples.
      */
     float importance_threshold{0.1f};
+    /**
+     * @brief The number of samples each pixel of a tile takes between convergence checks, once it has min_samples.
+     */
+    int importance_batch_size{16};
+    /**
+     * @brief Whether to save a heatmap of the samples spent per pixel next to the rendered image.
+     */
+    bool save_sample_heatmap{true};
 
     // Background settings
     /**
@@ -127,14 +176,87 @@ struct SceneConfig
      * @brief Whether to use Bounding Volume Hierarchy (BVH) for optimized scene traversal.
      */
     bool use_bvh = true;
+    /**
+     * @brief The BVH construction strategy: object median, binned surface area heuristic, LBVH or HLBVH.
+     */
+    BVHBuilder bvh_builder = BVHBuilder::SAH;
+    /**
+     * @brief The branching factor of the BVH: 2 for the binary LinearBVH, or 4/8 for a WideBVH
+     *        collapsed from it whose children are tested together with SIMD slab tests.
+     */
+    int bvh_width = 2;
+    /**
+     * @brief Whether built BVHs are stored in, and loaded from, the on-disk cache in bvh_cache_dir.
+     *        Entries are keyed by a hash of the objects' bounds and the BVH settings.
+     */
+    bool use_bvh_cache = true;
+    /**
+     * @brief The directory holding cached BVHs, created when the first entry is stored.
+     */
+    std::string bvh_cache_dir = "bvh_cache";
+    /**
+     * @brief The most megabytes of entries bvh_cache_dir may hold. Storing an entry removes the least recently
+     *        used entries beyond it; 0 lifts the limit.
+     */
+    int bvh_cache_max_mb = 1024;
     /**
      * @brief The number of samples per pixel to be used during rendering.
      */
     int samples_per_pixel = 10;
+    /**
+     * @brief Seed for every random number drawn while rendering. The same seed and scene give
+     *        the same image regardless of thread count.
+     */
+    unsigned int seed = 0;
+    /**
+     * @brief The sampler used for every random decision made while rendering.
+     */
+    SamplerType sampler = SamplerType::RANDOM;
     /**
      * @brief The maximum recursion depth for rays.
      */
     int max_ray_depth = 10;
+    /**
+     * @brief How pixels are shared out between rendering threads.
+     */
+    RenderScheduler scheduler = RenderScheduler::TILES;
+    /**
+     * @brief The side in pixels of the square tiles used by the TILES scheduler.
+     */
+    int tile_size = 32;
+    /**
+     * @brief When positive, path tracing ignores nsamples and keeps adding passes of progressive_pass_samples
+     *        samples to the noisiest tiles until this many milliseconds have passed, including the time to write
+     *        the output.
+     */
+    float time_budget_ms = 0.0f;
+    /**
+     * @brief Whether path tracing adds samples in passes over the whole frame, saving the accumulated sums to
+     *        checkpoint_path as it goes so that an interrupted render can resume.
+     */
+    bool progressive = false;
+    /**
+     * @brief The number of samples each pixel takes per progressive pass.
+     */
+    int progressive_pass_samples = 4;
+    /**
+     * @brief The checkpoint file of a progressive render. When empty, the output file name with a .rtck
+     *        extension is used.
+     */
+    std::string checkpoint_path;
+    /**
+     * @brief The least time in seconds between two checkpoint saves. The final pass is always saved.
+     */
+    float checkpoint_interval = 60.0f;
+    /**
+     * @brief Whether a progressive render continues from a matching checkpoint instead of starting from zero.
+     */
+    bool resume = true;
+    /**
+     * @brief A hash of the scene description without the settings that cannot change a sample, from
+     *        RenderCheckpoint::description_key. Set by SceneLoader for progressive renders.
+     */
+    uint64_t description_key = 0;
 
     // Camera settings
     /**
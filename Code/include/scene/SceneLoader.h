@@ -3,10 +3,16 @@
 
 #include "scene/Scene.h"
 #include "scene/SceneConfig.h"
+#include "scene/SceneBinary.h"
 #include "geometry/BVHNode.h"
+#include "geometry/LinearBVH.h"
+#include "geometry/WideBVH.h"
 #include "geometry/HittableList.h"
 #include <nlohmann/json.hpp>
 
+#include <string>
+#include <unordered_map>
+
 /**
  * @class SceneLoader
  * @brief Responsible for loading and setting up scenes from different sources.
@@ -23,6 +29,15 @@ public:
      */
     void load_default_scene(Scene &scene, SceneConfig &config);
 
+    /**
+     * @brief Loads a scene from a file, choosing the format by its extension: .rtbin files are mapped
+     *        with load_scene_from_binary, anything else is read as JSON.
+     * @param scene The scene to populate.
+     * @param config The scene configuration to fill from the file.
+     * @param path The path of the scene file.
+     */
+    void load_scene_from_file(Scene &scene, SceneConfig &config, const std::string &path);
+
     /**
      * @brief Loads a custom scene from a JSON file and sets up the scene components accordingly.
      * @param scene The scene to populate with the data from the JSON file.
@@ -31,6 +46,15 @@ public:
      */
     void load_scene_from_json(Scene &scene, SceneConfig &config, const std::string &json_path);
 
+    /**
+     * @brief Loads a scene from a .rtbin file produced by SceneBinary::convert. Mesh buffers, and the BVH if the
+     *        file holds one built with the same settings, are used in place from the mapped file.
+     * @param scene The scene to populate.
+     * @param config The scene configuration to fill from the file.
+     * @param rtbin_path The path of the .rtbin file.
+     */
+    void load_scene_from_binary(Scene &scene, SceneConfig &config, const std::string &rtbin_path);
+
 private:
     /**
      * @brief Builds the scene by setting up all necessary components, such as the camera, lights, and objects.
@@ -39,6 +63,17 @@ private:
      */
     void build_scene(Scene &scene, SceneConfig &config);
 
+    /**
+     * @brief Builds the hierarchy over a list of objects: a BVH with the configured width and builder, taken
+     *        from the BVH cache when possible, or a HittableList when BVHs are disabled. Objects without a
+     *        bounding box, such as planes, are kept out of the BVH in a SplitHierarchy.
+     * @param objects The objects to build over.
+     * @param config The scene configuration.
+     * @return The root of the hierarchy.
+     */
+    std::shared_ptr<Hittable> build_hierarchy(const std::vector<std::shared_ptr<Hittable>> &objects,
+                                              const SceneConfig &config);
+
     /**
      * @brief Sets up the default scene with predefined settings.
      * @param scene The scene to populate with default data.
@@ -93,6 +128,24 @@ private:
      */
     void parse_shapes(Scene &scene, SceneConfig &config, const nlohmann::json &shapes_json);
 
+    /**
+     * @brief Parses the prototypes of a scene: named lists of shapes, each gathered under its own bottom-level
+     *        hierarchy that instances share. Prototypes may not contain instances.
+     * @param scene The scene, which receives the prototypes' materials and meshes but not their objects.
+     * @param config The scene configuration.
+     * @param prototypes_json The JSON object mapping prototype names to objects with a "shapes" list.
+     */
+    void parse_prototypes(Scene &scene, SceneConfig &config, const nlohmann::json &prototypes_json);
+
+    /**
+     * @brief Parses an "instance" shape and adds an Instance of its prototype to the scene. The transformation is
+     *        either a row-major 3x4 "matrix", or a "scale" (a number or per-axis), "rotation" (degrees about X,
+     *        then Y, then Z) and "translation", applied in that order.
+     * @param scene The scene to add the instance to.
+     * @param instance_json The JSON data of the instance.
+     */
+    void parse_instance(Scene &scene, const nlohmann::json &instance_json);
+
     /**
      * @brief Parses material data from the JSON structure and returns a material object.
      * @param config The scene configuration.
@@ -107,6 +160,21 @@ private:
      * @return A Vec3 object corresponding to the parsed JSON data.
      */
     Vec3 parse_vec3(const nlohmann::json &json_array);
+
+    /**
+     * @struct Prototype
+     * @brief Shared geometry that instances place in the scene.
+     */
+    struct Prototype
+    {
+        std::shared_ptr<const Hittable> root; ///< The prototype's hierarchy, or its only object.
+        size_t object_count = 0;              ///< Number of objects in the prototype.
+        size_t instance_count = 0;            ///< Number of instances placed so far.
+    };
+
+    std::shared_ptr<SceneBinary> binary; ///< The .rtbin file being loaded, or nullptr while loading JSON.
+    std::unordered_map<std::string, Prototype> prototypes; ///< The prototypes of the scene being loaded, by name.
+    bool parsing_prototype = false;      ///< Whether the shapes being parsed belong to a prototype.
 };
 
 #endif // SCENE_LOADER_H
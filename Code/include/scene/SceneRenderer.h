@@ -9,9 +9,12 @@
 #include "scene/SceneConfig.h"
 #include "materials/Material.h"
 #include "core/Pathtracer.h"
+#include "core/ImportanceSampler.h"
+#include "core/TileScheduler.h"
 
 #include <nlohmann/json.hpp>
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <mutex>
@@ -33,6 +36,23 @@ public:
      */
     void render(Scene &scene, SceneConfig &config, std::string &output_path);
 
+    /**
+     * @brief Renders a scene into its image without reporting timings or saving it.
+     * @param scene The scene to be rendered.
+     * @param config The configuration settings for rendering.
+     * @return The time taken in seconds.
+     */
+    float render_image(Scene &scene, SceneConfig &config);
+
+    /**
+     * @brief Renders a scene with the scanline and the tile scheduler at 1, 2, 4, ... up to max_threads threads
+     *        and prints the time each takes. Progress output is suppressed and no image is saved.
+     * @param scene_path The JSON or .rtbin scene to render.
+     * @param max_threads The largest thread count to measure.
+     * @return 0 on success, 1 if the scene could not be loaded.
+     */
+    static int benchmark_schedulers(const std::string &scene_path, int max_threads);
+
 private:
     /**
      * @brief Renders the scene using the Phong or Binary rendering mode.
@@ -61,28 +81,132 @@ private:
      */
     void render_path(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels);
 
+    /**
+     * @brief Path traces the image in passes of config.progressive_pass_samples samples per pixel, resuming from
+     *        and periodically saving to config.checkpoint_path. Every sample is traced from its own index, so the
+     *        result is bit for bit that of sample_pixel however often the render was interrupted.
+     * @param scene The scene to be rendered.
+     * @param config The configuration settings for rendering.
+     * @param path_tracer The path tracing object used for sampling.
+     */
+    void render_path_progressive(Scene &scene, SceneConfig &config, Pathtracer &path_tracer);
+
+    /**
+     * @brief Path traces the image until config.time_budget_ms runs out. Every tile first takes two samples per
+     *        pixel; then each round gives another pass of samples to the half of the noisy tiles where it removes
+     *        the most squared error per second, by the importance sampler's error estimate. A thread only starts
+     *        a tile it expects to finish before the deadline, judged from the tile's earlier passes, and the time
+     *        to write the output is kept free at the end. Records the samples spent in sample_counts.
+     * @param scene The scene to be rendered.
+     * @param config The configuration settings for rendering.
+     * @param path_tracer The path tracing object used for sampling.
+     */
+    void render_path_budgeted(Scene &scene, SceneConfig &config, Pathtracer &path_tracer);
+
+    /**
+     * @brief Shades all samples of a pixel with the Phong or Binary materials and averages them.
+     *        Reads the scene only through const methods and draws jitter from the calling thread's sampler,
+     *        so it can run on any number of threads at once.
+     * @param x The x-coordinate of the pixel.
+     * @param y The y-coordinate of the pixel.
+     * @param scene The scene to be rendered.
+     * @param config The configuration settings for rendering.
+     * @return The color value of the shaded pixel.
+     */
+    Vec3 shade_pixel(int x, int y, Scene &scene, SceneConfig &config) const;
+
+    /**
+     * @brief Computes every tile of the image in parallel, sharing them out between threads as set by
+     *        config.scheduler. With TILES, each tile is rendered into its own buffer and the buffers are copied
+     *        into the image once all are done, so threads never write to the same cache line. With SCANLINES,
+     *        each row of the image is a tile.
+     * @param scene The scene whose image receives the pixels.
+     * @param config The configuration settings for rendering.
+     * @param pixels_done A reference to an atomic integer tracking the number of completed pixels.
+     * @param total_pixels The total number of pixels to be rendered.
+     * @param compute_tile Fills the colors of a tile's pixels, row by row. Called once per tile on the rendering
+     *        threads, after the thread's sampler has been set up.
+     */
+    template <typename TileFunction>
+    void render_tiles(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels,
+                      TileFunction compute_tile);
+
+    /**
+     * @brief Computes every pixel of the image in parallel through render_tiles.
+     * @param scene The scene whose image receives the pixels.
+     * @param config The configuration settings for rendering.
+     * @param pixels_done A reference to an atomic integer tracking the number of completed pixels.
+     * @param total_pixels The total number of pixels to be rendered.
+     * @param compute_pixel Returns the color of pixel (x, y). Called once per pixel on the rendering threads,
+     *        after the thread's sampler has been set up.
+     */
+    template <typename PixelFunction>
+    void render_pixels(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels,
+                       PixelFunction compute_pixel);
+
     /**
      * @brief Updates the progress of the rendering process and displays it to the console.
      * @param pixels_done A reference to an atomic integer tracking the number of completed pixels.
      * @param total_pixels The total number of pixels to be rendered.
+     * @param count The number of pixels just completed.
      */
-    void update_progress(std::atomic<int> &pixels_done, int total_pixels);
+    void update_progress(std::atomic<int> &pixels_done, int total_pixels, int count = 1);
 
     /**
-     * @brief Samples a pixel during the rendering process.
+     * @brief Path traces all samples of a pixel and averages them.
      * @param x The x-coordinate of the pixel.
      * @param y The y-coordinate of the pixel.
-     * @param num_samples The number of samples to take for the pixel.
-     * @param stratified_sampling Whether stratified sampling is enabled.
      * @param scene The scene to be rendered.
      * @param config The configuration settings for rendering.
      * @param path_tracer The path tracing object used for sampling.
      * @return The color value of the sampled pixel.
      */
-    Vec3 sample_pixel(int x, int y, int num_samples, bool stratified_sampling, Scene &scene, SceneConfig &config, Pathtracer &path_tracer);
+    Vec3 sample_pixel(int x, int y, Scene &scene, SceneConfig &config, Pathtracer &path_tracer);
+
+    /**
+     * @brief Path traces sample s of a pixel. With stratified sampling, s selects the stratum sx = s % sqrt_samples,
+     *        sy = s / sqrt_samples. The sample depends only on the seed, the pixel and s.
+     * @param x The x-coordinate of the pixel.
+     * @param y The y-coordinate of the pixel.
+     * @param s The index of the sample within the pixel.
+     * @param scene The scene to be rendered.
+     * @param config The configuration settings for rendering.
+     * @param path_tracer The path tracing object used for sampling.
+     * @return The radiance of the sample.
+     */
+    Vec3 trace_sample(int x, int y, int s, Scene &scene, SceneConfig &config, Pathtracer &path_tracer);
+
+    /**
+     * @brief Path traces a tile with adaptive sampling: all of its pixels take batches of samples until the
+     *        importance sampler judges the tile converged. Records the samples spent in sample_counts.
+     * @param tile The tile to render.
+     * @param pixels Receives the tile's averaged colors, row by row.
+     * @param scene The scene to be rendered.
+     * @param config The configuration settings for rendering, with stratified sampling off.
+     * @param path_tracer The path tracing object used for sampling.
+     * @param importance_sampler Keeps the per-pixel statistics and decides when the tile has converged.
+     */
+    void sample_tile(const Tile &tile, Vec3 *pixels, Scene &scene, SceneConfig &config, Pathtracer &path_tracer,
+                     const ImportanceSampler &importance_sampler);
+
+    /**
+     * @brief Adds samples [samples, batch_end) to every pixel of a tile.
+     * @param tile The tile to sample.
+     * @param stats The statistics of the tile's pixels, row by row.
+     * @param samples The number of samples each pixel has taken.
+     * @param batch_end The number of samples each pixel should have afterwards.
+     * @param scene The scene to be rendered.
+     * @param config The configuration settings for rendering.
+     * @param path_tracer The path tracing object used for sampling.
+     * @param importance_sampler Updates the statistics.
+     */
+    void sample_tile_batch(const Tile &tile, ImportanceSampler::SampleStats *stats, int samples, int batch_end,
+                           Scene &scene, SceneConfig &config, Pathtracer &path_tracer,
+                           const ImportanceSampler &importance_sampler);
 
     // Scene components
-    std::mutex console_mutex; ///< Mutex to protect the console output from concurrent access.
+    std::mutex console_mutex;       ///< Mutex to protect the console output from concurrent access.
+    std::vector<int> sample_counts; ///< Samples taken per pixel by the last adaptive render; empty otherwise.
 
     // Helper methods
     /**
@@ -2,19 +2,64 @@
 #include "scene/SceneRenderer.h"
 #include "scene/SceneLoader.h"
 
+#include "scene/SceneBinary.h"
+
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 #include <iostream>
+#include <string>
 
 int main(int argc, char *argv[])
 {
+    // raytracer convert <scene.json> <scene.rtbin> [--no-bvh]
+    if (argc > 1 && std::string(argv[1]) == "convert")
+    {
+        if (argc < 4)
+        {
+            std::cerr << "Usage: " << argv[0] << " convert <scene.json> <scene.rtbin> [--no-bvh]" << std::endl;
+            return 1;
+        }
+        bool with_bvh = !(argc > 4 && std::string(argv[4]) == "--no-bvh");
+        return SceneBinary::convert(argv[2], argv[3], with_bvh) ? 0 : 1;
+    }
+
+    // raytracer benchmark <scene> [max_threads]
+    if (argc > 1 && std::string(argv[1]) == "benchmark")
+    {
+        if (argc < 3)
+        {
+            std::cerr << "Usage: " << argv[0] << " benchmark <scene> [max_threads]" << std::endl;
+            return 1;
+        }
+        int max_threads = argc > 3 ? std::max(std::atoi(argv[3]), 1) : 64;
+        return SceneRenderer::benchmark_schedulers(argv[2], max_threads);
+    }
+
     Scene scene;
     SceneConfig config;
     SceneLoader loader;
     SceneRenderer renderer;
 
+    // raytracer [scene] [--no-bvh-cache] [--no-resume]
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--no-bvh-cache")
+            config.use_bvh_cache = false;
+        else if (std::string(argv[i]) == "--no-resume")
+            config.resume = false;
+        else
+            std::cerr << "Warning: Unknown option '" << argv[i] << "' ignored." << std::endl;
+    }
+
     if (argc > 1)
     {
-        loader.load_scene_from_json(scene, config, argv[1]);
+        loader.load_scene_from_file(scene, config, argv[1]);
+        if (!scene.camera || !scene.scene_root)
+        {
+            std::cerr << "Error: Could not load a renderable scene from '" << argv[1] << "'." << std::endl;
+            return 1;
+        }
     }
     else
     {
@@ -31,12 +31,26 @@ Camera::Camera(Vec3 lookfrom, Vec3 lookat, Vec3 vup,
 
 Vec3 Camera::random_in_unit_disk() const
 {
-    while (true)
+    // Concentric mapping of a 2D sample, so stratified samples stay stratified on the lens
+    float u1, u2;
+    random_float2(u1, u2);
+    float a = 2.0f * u1 - 1.0f;
+    float b = 2.0f * u2 - 1.0f;
+    if (a == 0.0f && b == 0.0f)
+        return Vec3(0, 0, 0);
+
+    float r, theta;
+    if (std::fabs(a) > std::fabs(b))
+    {
+        r = a;
+        theta = (M_PI / 4.0f) * (b / a);
+    }
+    else
     {
-        Vec3 p(random_float(-1, 1), random_float(-1, 1), 0);
-        if (p.dot(p) < 1)
-            return p;
+        r = b;
+        theta = (M_PI / 2.0f) - (M_PI / 4.0f) * (a / b);
     }
+    return Vec3(r * std::cos(theta), r * std::sin(theta), 0);
 }
 
 Ray Camera::get_ray(float s, float t) const
@@ -0,0 +1,98 @@
+#include "core/HaltonSampler.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+/**
+ * Returns the first HaltonSampler::kMaxDimensions primes, computed once.
+ */
+const std::vector<uint32_t> &primes()
+{
+    static const std::vector<uint32_t> table = []
+    {
+        std::vector<uint32_t> result;
+        std::vector<bool> composite(16384, false);
+        for (uint32_t n = 2; result.size() < HaltonSampler::kMaxDimensions; ++n)
+        {
+            if (composite[n])
+                continue;
+            result.push_back(n);
+            for (uint32_t m = n * n; m < composite.size(); m += n)
+                composite[m] = true;
+        }
+        return result;
+    }();
+    return table;
+}
+
+/**
+ * Returns element i of a pseudo-random permutation of [0, length) selected by the hash, without building
+ * the permutation (Kensler, "Correlated Multi-Jittered Sampling"). A full permutation is needed rather
+ * than a digit rotation: rotating the leading digits of two large bases leaves their first points on a line.
+ */
+uint32_t permutation_element(uint32_t i, uint32_t length, uint32_t hash)
+{
+    uint32_t mask = length - 1;
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+    do
+    {
+        i ^= hash;
+        i *= 0xe170893d;
+        i ^= hash >> 16;
+        i ^= (i & mask) >> 4;
+        i ^= hash >> 8;
+        i *= 0x0929eb3f;
+        i ^= hash >> 23;
+        i ^= (i & mask) >> 1;
+        i *= 1 | hash >> 27;
+        i *= 0x6935fa69;
+        i ^= (i & mask) >> 11;
+        i *= 0x74dcb303;
+        i ^= (i & mask) >> 2;
+        i *= 0x9e501cc3;
+        i ^= (i & mask) >> 2;
+        i *= 0xc860a3df;
+        i &= mask;
+        i ^= i >> 5;
+    } while (i >= length);
+    return (i + hash) % length;
+}
+} // namespace
+
+float HaltonSampler::sample_dimension(uint32_t dimension)
+{
+    if (dimension >= kMaxDimensions)
+        return rng.next_float();
+
+    const uint32_t base = primes()[dimension];
+    const double inv_base = 1.0 / base;
+    const uint64_t hash = mix_bits(pixel_index ^ mix_bits((static_cast<uint64_t>(seed) << 32) | dimension));
+
+    // Permute every digit that can reach the float mantissa, including the leading zeros of the index,
+    // so the result is uniformly distributed rather than only permuted
+    uint64_t index = sample_index;
+    uint64_t prefix = 0;
+    double weight = 1.0;
+    double result = 0.0;
+    for (uint32_t position = 0; weight > 0x1p-24; ++position)
+    {
+        uint32_t digit = static_cast<uint32_t>(index % base);
+        index /= base;
+
+        // Each node of the digit tree, identified by the digits above it, gets its own permutation
+        uint32_t digit_hash = static_cast<uint32_t>(mix_bits(hash ^ (prefix * 0x9e3779b97f4a7c15ULL + position)));
+        digit = permutation_element(digit, base, digit_hash);
+
+        weight *= inv_base;
+        result += digit * weight;
+        prefix = prefix * base + digit;
+    }
+
+    return std::min(static_cast<float>(result), 0x1.fffffep-1f);
+}
@@ -1,10 +1,91 @@
 #include "core/ImportanceSampler.h"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
 float ImportanceSampler::calculate_luminance(const Vec3& color) const {
         return 0.299f * color.x + 0.587f * color.y + 0.114f * color.z;
 }
 
-float ImportanceSampler::calculate_importance(const Vec3& pixel_color) const {
-    float lum = calculate_luminance(pixel_color);
-    return lum * (1.0f - lum);
+void ImportanceSampler::add_sample(SampleStats &stats, const Vec3 &color) const
+{
+    float luminance = calculate_luminance(color);
+    stats.sum += color;
+    stats.samples++;
+
+    // Welford's update of the running mean and sum of squared deviations
+    float delta = luminance - stats.mean;
+    stats.mean += delta / stats.samples;
+    stats.m2 += delta * (luminance - stats.mean);
+}
+
+float ImportanceSampler::tile_error(const SampleStats *stats, int count) const
+{
+    float squared_error = 0.0f;
+    float displayed = 0.0f;
+    for (int i = 0; i < count; ++i)
+    {
+        if (stats[i].samples < 2)
+        {
+            return INFINITY;
+        }
+
+        // Reinhard maps L to L / (1 + L), scaling errors by its derivative 1 / (1 + L)^2
+        float mean = std::max(stats[i].mean, 0.0f);
+        float slope = config.use_tone_mapping ? 1.0f / ((1.0f + mean) * (1.0f + mean)) : 1.0f;
+        float variance = stats[i].m2 / (stats[i].samples - 1);
+        squared_error += slope * slope * variance / stats[i].samples;
+        displayed += config.use_tone_mapping ? mean / (1.0f + mean) : mean;
+    }
+
+    float rms_error = std::sqrt(squared_error / count);
+    return rms_error / std::max(displayed / count, kMinLuminance);
+}
+
+int ImportanceSampler::next_batch_end(int samples, float error) const
+{
+    const int min_samples = std::max(config.min_samples, 1);
+    const int max_samples = std::max(config.max_samples, min_samples);
+
+    if (samples < min_samples)
+    {
+        return min_samples;
+    }
+    if (samples >= max_samples || error < config.importance_threshold)
+    {
+        return samples;
+    }
+    return std::min(samples + std::max(config.importance_batch_size, 1), max_samples);
+}
+
+bool ImportanceSampler::save_heatmap(const SceneConfig &config, const std::vector<int> &sample_counts,
+                                     const std::string &filename)
+{
+    std::ofstream file(filename);
+    if (!file)
+    {
+        std::cerr << "Error: Could not open file " << filename << " for writing\n";
+        return false;
+    }
+
+    file << "P3\n"
+         << config.image_width << " " << config.image_height << "\n255\n";
+
+    const int fewest = *std::min_element(sample_counts.begin(), sample_counts.end());
+    const int most = *std::max_element(sample_counts.begin(), sample_counts.end());
+    const float range = std::max(most - fewest, 1);
+    auto channel = [](float v) { return static_cast<int>(255.0f * std::min(std::max(v, 0.0f), 1.0f)); };
+
+    for (int y = config.image_height - 1; y >= 0; --y)
+    {
+        for (int x = 0; x < config.image_width; ++x)
+        {
+            float t = (sample_counts[static_cast<size_t>(y) * config.image_width + x] - fewest) / range;
+            file << channel(3.0f * t) << " " << channel(3.0f * t - 1.0f) << " " << channel(3.0f * t - 2.0f) << "\n";
+        }
+    }
+
+    return true;
 }
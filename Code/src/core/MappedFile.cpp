@@ -0,0 +1,91 @@
+#include "core/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &filename)
+{
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    std::shared_ptr<MappedFile> mapped(new MappedFile());
+    mapped->bytes = static_cast<const char *>(view);
+    mapped->length = static_cast<size_t>(size.QuadPart);
+    mapped->file_handle = file;
+    mapped->mapping_handle = mapping;
+    return mapped;
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes)
+        UnmapViewOfFile(bytes);
+    if (mapping_handle)
+        CloseHandle(mapping_handle);
+    if (file_handle)
+        CloseHandle(file_handle);
+}
+#else
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return nullptr;
+
+    std::shared_ptr<MappedFile> mapped(new MappedFile());
+    mapped->bytes = static_cast<const char *>(view);
+    mapped->length = static_cast<size_t>(info.st_size);
+    return mapped;
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes)
+        munmap(const_cast<char *>(bytes), length);
+}
+#endif
@@ -1,65 +1,103 @@
 #include "core/Pathtracer.h"
 
-Vec3 Pathtracer::trace(const Ray &ray, const Hittable &world, int depth, const std::vector<std::shared_ptr<Light>> &lights)
+namespace
+{
+/**
+ * A scattering vertex of the current path. The radiance leaving it is
+ * clamp(radiance + weight * incoming / pdf), where incoming is the radiance leaving the next vertex.
+ */
+struct PathVertex
 {
-    if (depth <= 0)
-        return Vec3(0, 0, 0);
+    Vec3 radiance; ///< Emitted plus direct light at the vertex.
+    Vec3 weight;   ///< BRDF or specular attenuation applied to the incoming radiance.
+    float pdf;     ///< Density of the sampled direction, 1 for specular vertices.
+};
+} // namespace
 
-    HitRecord rec;
-    if (!world.hit(ray, 0.001f, std::numeric_limits<float>::infinity(), rec))
+Vec3 Pathtracer::trace(const Ray &ray, const Hittable &world, int depth, const std::vector<std::shared_ptr<Light>> &lights)
+{
+    // Reused between calls so the path never allocates once it has reached its longest length
+    thread_local std::vector<PathVertex> vertices;
+    vertices.clear();
+
+    Ray current = ray;
+    // The radiance arriving at the last vertex; zero if the path runs out of depth
+    Vec3 radiance(0, 0, 0);
+    for (int remaining = depth; remaining > 0; --remaining)
     {
-        return background_color(ray);
-    }
-
-    ScatterRecord scatter_rec;
-    Vec3 emitted = rec.material_ptr->emitted(rec, rec.u, rec.v, rec.point);
+        // Every path vertex draws from its own stream, so earlier bounces cannot shift later ones. Bounce 0 is
+        // the camera ray, so the first vertex is bounce 1 whatever depth the path started with
+        begin_bounce(static_cast<uint32_t>(depth - remaining + 1));
 
-    if (!rec.material_ptr->scatter(ray, rec, scatter_rec))
-    {
-        return clamp_radiance(emitted);
-    }
+        HitRecord rec;
+        if (!world.hit(current, 0.001f, std::numeric_limits<float>::infinity(), rec))
+        {
+            radiance = background_color(current);
+            break;
+        }
+        rec.primitive->compute_interaction(current, rec, materials);
 
-    // Calculate throughput probability for Russian Roulette
-    Vec3 throughput = scatter_rec.attenuation;
-    float max_channel = std::max(throughput.x, std::max(throughput.y, throughput.z));
-    float roulette_probability = std::clamp(max_channel, 0.1f, 1.0f);
+        const Material &material = materials[rec.material_id];
+        ScatterRecord scatter_rec;
+        Vec3 emitted = material.emitted(rec, rec.u, rec.v, rec.point);
+        if (!material.scatter(current, rec, scatter_rec))
+        {
+            radiance = clamp_radiance(emitted);
+            break;
+        }
 
-    if (depth > 2 && random_float() > roulette_probability)
-    {
-        return clamp_radiance(emitted);
-    }
+        // Calculate throughput probability for Russian Roulette
+        Vec3 throughput = scatter_rec.attenuation;
+        float max_channel = std::max(throughput.x, std::max(throughput.y, throughput.z));
+        float roulette_probability = std::clamp(max_channel, 0.1f, 1.0f);
 
-    // Account for the survival probability in the recursion
-    scatter_rec.attenuation /= roulette_probability;
+        if (remaining > 2 && random_float() > roulette_probability)
+        {
+            radiance = clamp_radiance(emitted);
+            break;
+        }
 
-    Vec3 direct_lighting = Vec3(0, 0, 0);
-    if (emitted.length() * emitted.length() < 0.001f)
-    {
-        direct_lighting = compute_direct_lighting(rec, world, ray, lights);
-    }
+        // Account for the survival probability in the continuation
+        scatter_rec.attenuation /= roulette_probability;
 
-    Vec3 indirect_lighting;
-    if (scatter_rec.specular_ray)
-    {
-        Ray scattered(rec.point, scatter_rec.specular_direction);
-        indirect_lighting = trace(scattered, world, depth - 1, lights);
-        return clamp_radiance(emitted + scatter_rec.attenuation * indirect_lighting);
-    }
-    else if (scatter_rec.pdf_ptr)
-    {
-        Vec3 direction = scatter_rec.pdf_ptr->generate();
-        Ray scattered(rec.point, direction);
-        float pdf = scatter_rec.pdf_ptr->value(direction);
+        if (scatter_rec.specular_ray)
+        {
+            vertices.push_back({emitted, scatter_rec.attenuation, 1.0f});
+            current = Ray(rec.point, scatter_rec.specular_direction);
+            continue;
+        }
+        if (!scatter_rec.pdf)
+        {
+            radiance = clamp_radiance(emitted);
+            break;
+        }
 
+        Vec3 direction = scatter_rec.pdf.generate();
+        float pdf = scatter_rec.pdf.value(direction);
         if (pdf <= 0.0f)
-            return clamp_radiance(emitted);
+        {
+            radiance = clamp_radiance(emitted);
+            break;
+        }
+
+        // Only diffuse vertices use direct lighting, so specular ones skip the shadow rays
+        Vec3 direct_lighting = Vec3(0, 0, 0);
+        if (emitted.length() * emitted.length() < 0.001f)
+        {
+            direct_lighting = compute_direct_lighting(rec, world, current, lights);
+        }
 
-        indirect_lighting = trace(scattered, world, depth - 1, lights);
-        Vec3 brdf = rec.material_ptr->brdf(rec, -ray.direction(), direction);
-        return clamp_radiance(emitted + direct_lighting + (brdf * indirect_lighting) / pdf);
+        Vec3 brdf = material.brdf(rec, -current.direction(), direction);
+        vertices.push_back({emitted + direct_lighting, brdf, pdf});
+        current = Ray(rec.point, direction);
     }
 
-    return clamp_radiance(emitted);
+    // Fold the path back to the camera, clamping at every vertex as the radiance leaves it
+    for (auto vertex = vertices.rbegin(); vertex != vertices.rend(); ++vertex)
+    {
+        radiance = clamp_radiance(vertex->radiance + (vertex->weight * radiance) / vertex->pdf);
+    }
+    return radiance;
 }
 
 Vec3 Pathtracer::background_color(const Ray &ray)
@@ -83,6 +121,7 @@ Vec3 Pathtracer::compute_direct_lighting(const HitRecord &rec,
                                          const std::vector<std::shared_ptr<Light>> &lights)
 {
     Vec3 direct_light(0, 0, 0);
+    const Material &material = materials[rec.material_id];
 
     for (const auto &light : lights)
     {
@@ -97,10 +136,9 @@ Vec3 Pathtracer::compute_direct_lighting(const HitRecord &rec,
 
         // Shadow ray
         Ray shadow_ray(rec.point, light_dir);
-        HitRecord shadow_rec;
 
         // Check for shadows
-        if (!world.hit(shadow_ray, 0.001f, distance - 0.001f, shadow_rec))
+        if (!world.occluded(shadow_ray, 0.001f, distance - 0.001f))
         {
             float cos_theta = std::max(0.0f, rec.normal.dot(light_dir));
 
@@ -110,7 +148,7 @@ Vec3 Pathtracer::compute_direct_lighting(const HitRecord &rec,
                 float distance_squared = distance * distance;
                 Vec3 attenuated_intensity = light_intensity / distance_squared;
 
-                Vec3 brdf = rec.material_ptr->brdf(rec, -incident_ray.direction(), light_dir);
+                Vec3 brdf = material.brdf(rec, -incident_ray.direction(), light_dir);
                 direct_light += brdf * attenuated_intensity * cos_theta;
             }
         }
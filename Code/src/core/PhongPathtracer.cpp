@@ -6,7 +6,8 @@
 #include <cmath>
 #include <cstdlib>
 
-PhongPathtracer::PhongPathtracer(int max_depth) : max_depth(max_depth) {}
+PhongPathtracer::PhongPathtracer(int max_depth, const MaterialTable &materials)
+    : max_depth(max_depth), materials(materials) {}
 
 // Path tracing function
 Vec3 PhongPathtracer::trace(const Ray &ray, const Hittable &scene, int depth, SceneConfig &config, const std::vector<std::shared_ptr<Light>> lights) const
@@ -20,11 +21,12 @@ Vec3 PhongPathtracer::trace(const Ray &ray, const Hittable &scene, int depth, Sc
     HitRecord rec;
     if (scene.hit(ray, 0.001f, FLT_MAX, rec))
     {
+        rec.primitive->compute_interaction(ray, rec, materials);
         Vec3 scatter_direction;
         float pdf;
 
         // Scatter the ray using the material's properties
-        Vec3 attenuation = rec.material_ptr->scatter(ray, rec, scatter_direction, pdf);
+        Vec3 attenuation = materials[rec.material_id].scatter(ray, rec, scatter_direction, pdf);
 
         // Shadow Ray Contribution
         Vec3 direct_lighting(0, 0, 0);
@@ -37,9 +39,8 @@ Vec3 PhongPathtracer::trace(const Ray &ray, const Hittable &scene, int depth, Sc
                 float light_distance = (light.position - rec.point).length();
 
                 Ray shadow_ray(rec.point + rec.normal * 1e-4f, light_dir);
-                HitRecord shadow_rec;
 
-                if (!scene.hit(shadow_ray, 0.001f, light_distance, shadow_rec))
+                if (!scene.occluded(shadow_ray, 0.001f, light_distance))
                 {
                     float light_intensity = std::max(0.0f, light_dir.dot(rec.normal));
                     float distance_factor = 1.0f / (light_distance * light_distance);              // Quadratic falloff
@@ -0,0 +1,69 @@
+#include "core/Sampler.h"
+#include "core/SobolSampler.h"
+#include "core/HaltonSampler.h"
+
+std::unique_ptr<Sampler> Sampler::create(SamplerType type)
+{
+    switch (type)
+    {
+    case SamplerType::SOBOL:
+        return std::make_unique<SobolSampler>();
+    case SamplerType::HALTON:
+        return std::make_unique<HaltonSampler>();
+    case SamplerType::RANDOM:
+    default:
+        return std::make_unique<RandomSampler>();
+    }
+}
+
+void Sampler::start_sample(uint32_t seed, uint64_t pixel_index, uint32_t sample_index)
+{
+    this->seed = seed;
+    this->pixel_index = pixel_index;
+    this->sample_index = sample_index;
+    start_bounce(0);
+}
+
+void Sampler::start_bounce(uint32_t bounce)
+{
+    this->bounce = bounce;
+    dimension_in_bounce = 0;
+
+    uint64_t key = (static_cast<uint64_t>(sample_index) << 32) | bounce;
+    rng.set_seed(mix_bits(key ^ mix_bits(seed)), pixel_index);
+}
+
+float Sampler::get_1d()
+{
+    if (dimension_in_bounce >= kDimensionsPerBounce)
+        return rng.next_float();
+
+    return sample_dimension(bounce * kDimensionsPerBounce + dimension_in_bounce++);
+}
+
+void Sampler::get_2d(float &u1, float &u2)
+{
+    dimension_in_bounce += dimension_in_bounce & 1u;
+    if (dimension_in_bounce + 1 >= kDimensionsPerBounce)
+    {
+        dimension_in_bounce = kDimensionsPerBounce;
+        u1 = rng.next_float();
+        u2 = rng.next_float();
+        return;
+    }
+
+    uint32_t dimension = bounce * kDimensionsPerBounce + dimension_in_bounce;
+    dimension_in_bounce += 2;
+    u1 = sample_dimension(dimension);
+    u2 = sample_dimension(dimension + 1);
+}
+
+uint64_t Sampler::mix_bits(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
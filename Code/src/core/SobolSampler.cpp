@@ -0,0 +1,60 @@
+#include "core/SobolSampler.h"
+
+namespace
+{
+uint32_t reverse_bits(uint32_t x)
+{
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00ff00ffu) << 8) | ((x & 0xff00ff00u) >> 8);
+    x = ((x & 0x0f0f0f0fu) << 4) | ((x & 0xf0f0f0f0u) >> 4);
+    x = ((x & 0x33333333u) << 2) | ((x & 0xccccccccu) >> 2);
+    x = ((x & 0x55555555u) << 1) | ((x & 0xaaaaaaaau) >> 1);
+    return x;
+}
+
+/**
+ * Second Sobol dimension, generated by the primitive polynomial x + 1. The first dimension is the
+ * van der Corput sequence, i.e. reverse_bits(index).
+ */
+uint32_t sobol_dimension1(uint32_t index)
+{
+    uint32_t result = 0;
+    for (uint32_t v = 1u << 31; index; index >>= 1, v ^= v >> 1)
+    {
+        if (index & 1u)
+            result ^= v;
+    }
+    return result;
+}
+
+/**
+ * Hash that only lets lower bits affect higher ones (Burley 2020, after Laine and Karras).
+ * Applied to bit-reversed values it becomes a nested uniform (Owen) scramble.
+ */
+uint32_t laine_karras_permutation(uint32_t x, uint32_t seed)
+{
+    x ^= x * 0x3d20adeau;
+    x += seed;
+    x *= (seed >> 16) | 1u;
+    x ^= x * 0x05526c56u;
+    x ^= x * 0x53a22864u;
+    return x;
+}
+
+uint32_t nested_uniform_scramble(uint32_t x, uint32_t seed)
+{
+    return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+}
+} // namespace
+
+float SobolSampler::sample_dimension(uint32_t dimension)
+{
+    // Both values of a pair share the shuffled index, so the pair stays a scrambled (0,2)-sequence
+    uint64_t pair_hash = mix_bits(pixel_index ^ mix_bits((static_cast<uint64_t>(seed) << 32) | (dimension >> 1)));
+    uint32_t index = nested_uniform_scramble(sample_index, static_cast<uint32_t>(pair_hash));
+
+    uint32_t value = (dimension & 1u) ? sobol_dimension1(index) : reverse_bits(index);
+    value = nested_uniform_scramble(value, static_cast<uint32_t>(mix_bits(pair_hash + 1 + (dimension & 1u))));
+
+    return static_cast<float>(value >> 8) * 0x1p-24f;
+}
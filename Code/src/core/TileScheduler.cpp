@@ -0,0 +1,93 @@
+#include "core/TileScheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace
+{
+/**
+ * Spreads the low 16 bits of v so that there is a zero bit between each of them.
+ */
+uint32_t expand_bits(uint32_t v)
+{
+    v &= 0xffff;
+    v = (v | v << 8) & 0x00ff00ff;
+    v = (v | v << 4) & 0x0f0f0f0f;
+    v = (v | v << 2) & 0x33333333;
+    v = (v | v << 1) & 0x55555555;
+    return v;
+}
+
+/**
+ * Interleaves two tile coordinates into a Morton code, with y in the higher bit of each pair.
+ */
+uint32_t morton_code(int tx, int ty)
+{
+    return (expand_bits(static_cast<uint32_t>(ty)) << 1) | expand_bits(static_cast<uint32_t>(tx));
+}
+} // namespace
+
+TileScheduler::TileScheduler(int width, int height, int tile_size, int n_workers)
+    : queues(std::max(n_workers, 1))
+{
+    tile_size = std::max(tile_size, 1);
+    const int tiles_x = (width + tile_size - 1) / tile_size;
+    const int tiles_y = (height + tile_size - 1) / tile_size;
+
+    std::vector<std::pair<uint32_t, Tile>> ordered;
+    ordered.reserve(static_cast<size_t>(tiles_x) * tiles_y);
+    for (int ty = 0; ty < tiles_y; ++ty)
+    {
+        for (int tx = 0; tx < tiles_x; ++tx)
+        {
+            Tile tile{tx * tile_size, ty * tile_size, std::min((tx + 1) * tile_size, width),
+                      std::min((ty + 1) * tile_size, height)};
+            ordered.emplace_back(morton_code(tx, ty), tile);
+        }
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    tile_list.reserve(ordered.size());
+    for (const auto &entry : ordered)
+        tile_list.push_back(entry.second);
+
+    // Deal out contiguous runs of the curve, as even as the tile count allows
+    const int n_tiles = static_cast<int>(tile_list.size());
+    const int n_queues = static_cast<int>(queues.size());
+    for (int w = 0; w < n_queues; ++w)
+    {
+        queues[w].begin = static_cast<int>(static_cast<int64_t>(n_tiles) * w / n_queues);
+        queues[w].end = static_cast<int>(static_cast<int64_t>(n_tiles) * (w + 1) / n_queues);
+    }
+}
+
+bool TileScheduler::next(int worker, int &tile_index)
+{
+    const int n_queues = static_cast<int>(queues.size());
+    worker %= n_queues;
+
+    {
+        WorkerQueue &own = queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.begin < own.end)
+        {
+            tile_index = own.begin++;
+            return true;
+        }
+    }
+
+    // Steal from the back of the next worker that still has tiles
+    for (int i = 1; i < n_queues; ++i)
+    {
+        WorkerQueue &victim = queues[(worker + i) % n_queues];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.begin < victim.end)
+        {
+            tile_index = --victim.end;
+            return true;
+        }
+    }
+    return false;
+}
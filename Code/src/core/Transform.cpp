@@ -0,0 +1,93 @@
+#include "core/Transform.h"
+
+Transform::Transform()
+    : m{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}}
+{
+}
+
+Transform::Transform(const float rows[12])
+{
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 4; ++c)
+            m[r][c] = rows[4 * r + c];
+}
+
+Transform Transform::translation(const Vec3 &offset)
+{
+    Transform t;
+    t.m[0][3] = offset.x;
+    t.m[1][3] = offset.y;
+    t.m[2][3] = offset.z;
+    return t;
+}
+
+Transform Transform::scaling(const Vec3 &factors)
+{
+    Transform t;
+    t.m[0][0] = factors.x;
+    t.m[1][1] = factors.y;
+    t.m[2][2] = factors.z;
+    return t;
+}
+
+Transform Transform::rotation(const Vec3 &degrees)
+{
+    float rx = degrees.x * M_PI / 180.0f;
+    float ry = degrees.y * M_PI / 180.0f;
+    float rz = degrees.z * M_PI / 180.0f;
+
+    const float x_rows[12] = {1, 0, 0, 0,
+                              0, std::cos(rx), -std::sin(rx), 0,
+                              0, std::sin(rx), std::cos(rx), 0};
+    const float y_rows[12] = {std::cos(ry), 0, std::sin(ry), 0,
+                              0, 1, 0, 0,
+                              -std::sin(ry), 0, std::cos(ry), 0};
+    const float z_rows[12] = {std::cos(rz), -std::sin(rz), 0, 0,
+                              std::sin(rz), std::cos(rz), 0, 0,
+                              0, 0, 1, 0};
+    return Transform(z_rows) * Transform(y_rows) * Transform(x_rows);
+}
+
+Transform Transform::operator*(const Transform &other) const
+{
+    Transform result;
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            float value = m[r][0] * other.m[0][c] + m[r][1] * other.m[1][c] + m[r][2] * other.m[2][c];
+            result.m[r][c] = c == 3 ? value + m[r][3] : value;
+        }
+    }
+    return result;
+}
+
+float Transform::determinant() const
+{
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+           m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+           m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+Transform Transform::inverse() const
+{
+    // The inverse of the linear part is its adjugate over the determinant
+    float inv_det = 1.0f / determinant();
+    Transform result;
+    result.m[0][0] = (m[1][1] * m[2][2] - m[1][2] * m[2][1]) * inv_det;
+    result.m[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inv_det;
+    result.m[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inv_det;
+    result.m[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) * inv_det;
+    result.m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inv_det;
+    result.m[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inv_det;
+    result.m[2][0] = (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * inv_det;
+    result.m[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inv_det;
+    result.m[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inv_det;
+
+    // The translation moves back by the original translation, expressed in the inverse's frame
+    Vec3 offset = result.vector(Vec3(m[0][3], m[1][3], m[2][3]));
+    result.m[0][3] = -offset.x;
+    result.m[1][3] = -offset.y;
+    result.m[2][3] = -offset.z;
+    return result;
+}
@@ -1,20 +1,56 @@
 #include "core/Utils.h"
 #include "core/Vec3.h"
+#include "core/Sampler.h"
 
+#include <atomic>
 #include <cmath>
-#include <cstdlib>
-#include <random>
+#include <memory>
+
+namespace
+{
+/// Hands each thread's default generator a different stream until it is explicitly seeded.
+std::atomic<uint64_t> next_thread_stream{0};
+
+thread_local PCG32 rng(0x853c49e6748fea9bULL, next_thread_stream.fetch_add(1, std::memory_order_relaxed));
+
+/// The sampler that random_float() and friends draw from on this thread.
+thread_local std::unique_ptr<Sampler> sampler = Sampler::create(SamplerType::RANDOM);
+} // namespace
+
+PCG32 &thread_rng()
+{
+    return rng;
+}
+
+void set_thread_sampler(SamplerType type)
+{
+    if (sampler->type() != type)
+        sampler = Sampler::create(type);
+}
+
+void begin_sample(uint32_t seed, uint64_t pixel_index, uint32_t sample_index)
+{
+    sampler->start_sample(seed, pixel_index, sample_index);
+}
+
+void begin_bounce(uint32_t bounce)
+{
+    sampler->start_bounce(bounce);
+}
 
 float random_float()
 {
-    static std::mt19937 generator(std::random_device{}());
-    static std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
-    return distribution(generator);
+    return sampler->get_1d();
 }
 
 float random_float(float min, float max)
 {
-    return min + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+    return min + (max - min) * sampler->get_1d();
+}
+
+void random_float2(float &u1, float &u2)
+{
+    sampler->get_2d(u1, u2);
 }
 
 Vec3 reflect(const Vec3 &v, const Vec3 &n)
@@ -47,36 +83,27 @@ float schlick(float cosine, float ref_idx)
 
 Vec3 random_unit_vector()
 {
-    float a = random_float(0, 2 * M_PI);
-    float z = random_float(-1, 1);
+    float u1, u2;
+    random_float2(u1, u2);
+    float a = 2.0f * M_PI * u1;
+    float z = 2.0f * u2 - 1.0f;
     float r = std::sqrt(1 - z * z);
     return Vec3(r * std::cos(a), r * std::sin(a), z);
 }
 
 Vec3 random_point_in_unit_sphere()
 {
-    while (true)
-    {
-        // Generate random x, y, z between -1 and 1
-        float x = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
-        float y = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
-        float z = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
-
-        Vec3 point(x, y, z);
-
-        // Check if the point lies inside the unit sphere
-        if (point.length() * point.length() <= 1.0f)
-        {
-            return point;
-        }
-    }
+    // A uniform direction scaled by the cube root of a uniform radius is uniform in the ball.
+    // Unlike rejection sampling this uses a fixed number of sample dimensions.
+    Vec3 direction = random_unit_vector();
+    return direction * std::cbrt(random_float());
 }
 
 Vec3 random_cosine_direction(const Vec3 &normal)
 {
     // Generate random numbers for polar coordinates
-    float r1 = static_cast<float>(rand()) / RAND_MAX;
-    float r2 = static_cast<float>(rand()) / RAND_MAX;
+    float r1, r2;
+    random_float2(r1, r2);
 
     // Convert to spherical coordinates (using concentric disk mapping)
     float phi = 2.0f * M_PI * r1;
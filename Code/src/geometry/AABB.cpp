@@ -1,5 +1,7 @@
 #include "geometry/AABB.h"
 
+#include <algorithm>
+
 AABB::AABB() : minimum(Vec3()), maximum(Vec3()) {}
 
 AABB::AABB(const Vec3 &min, const Vec3 &max) : minimum(min), maximum(max) {}
@@ -24,6 +26,32 @@ bool AABB::hit(const Ray &ray, float t_min, float t_max) const
     return true;
 }
 
+bool AABB::hit(const Vec3 &origin, const Vec3 &inv_direction, float t_min, float t_max) const
+{
+    float tx0 = (minimum.x - origin.x) * inv_direction.x;
+    float tx1 = (maximum.x - origin.x) * inv_direction.x;
+    float ty0 = (minimum.y - origin.y) * inv_direction.y;
+    float ty1 = (maximum.y - origin.y) * inv_direction.y;
+    float tz0 = (minimum.z - origin.z) * inv_direction.z;
+    float tz1 = (maximum.z - origin.z) * inv_direction.z;
+
+    t_min = std::max(t_min, std::max(std::min(tx0, tx1), std::max(std::min(ty0, ty1), std::min(tz0, tz1))));
+    t_max = std::min(t_max, std::min(std::max(tx0, tx1), std::min(std::max(ty0, ty1), std::max(tz0, tz1))));
+
+    return t_min <= t_max;
+}
+
+Vec3 AABB::centroid() const
+{
+    return 0.5f * (minimum + maximum);
+}
+
+float AABB::surface_area() const
+{
+    Vec3 d = maximum - minimum;
+    return 2.0f * (d.x * d.y + d.x * d.z + d.y * d.z);
+}
+
 AABB AABB::surrounding_box(const AABB &box0, const AABB &box1)
 {
     Vec3 small(
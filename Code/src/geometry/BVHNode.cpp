@@ -1,12 +1,22 @@
 #include "geometry/BVHNode.h"
+#include "core/Utils.h"
 #include <algorithm>
 
-BVHNode::BVHNode(const std::vector<std::shared_ptr<Hittable>> &objects,
-                 size_t start, size_t end)
+BVHNode::BVHNode(const std::vector<std::shared_ptr<Hittable>> &objects)
 {
+    // Copy once for the whole tree; every level below sorts its own range of this list
     auto objs = objects;
+    build(objs, 0, objs.size());
+}
+
+BVHNode::BVHNode(std::vector<std::shared_ptr<Hittable>> &objects, size_t start, size_t end)
+{
+    build(objects, start, end);
+}
 
-    int axis = rand() % 3;
+void BVHNode::build(std::vector<std::shared_ptr<Hittable>> &objs, size_t start, size_t end)
+{
+    int axis = static_cast<int>(thread_rng().next_uint(3));
     auto comparator = (axis == 0)   ? box_x_compare
                       : (axis == 1) ? box_y_compare
                                     : box_z_compare;
@@ -35,8 +45,8 @@ BVHNode::BVHNode(const std::vector<std::shared_ptr<Hittable>> &objects,
         std::sort(objs.begin() + start, objs.begin() + end, comparator);
 
         auto mid = start + object_span / 2;
-        left = std::make_shared<BVHNode>(objs, start, mid);
-        right = std::make_shared<BVHNode>(objs, mid, end);
+        left = std::shared_ptr<BVHNode>(new BVHNode(objs, start, mid));
+        right = std::shared_ptr<BVHNode>(new BVHNode(objs, mid, end));
     }
 
     AABB box_left, box_right;
@@ -57,14 +67,22 @@ bool BVHNode::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) cons
     return hit_left || hit_right;
 }
 
+bool BVHNode::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    if (!box.hit(ray, t_min, t_max))
+        return false;
+
+    return left->occluded(ray, t_min, t_max) || right->occluded(ray, t_min, t_max);
+}
+
 bool BVHNode::bounding_box(AABB &output_box) const
 {
     output_box = box;
     return true;
 }
 
-bool BVHNode::box_compare(const std::shared_ptr<Hittable> a,
-                          const std::shared_ptr<Hittable> b, int axis)
+bool BVHNode::box_compare(const std::shared_ptr<Hittable> &a,
+                          const std::shared_ptr<Hittable> &b, int axis)
 {
     AABB box_a, box_b;
     if (!a->bounding_box(box_a) || !b->bounding_box(box_b))
@@ -73,20 +91,20 @@ bool BVHNode::box_compare(const std::shared_ptr<Hittable> a,
     return box_a.minimum[axis] < box_b.minimum[axis];
 }
 
-bool BVHNode::box_x_compare(const std::shared_ptr<Hittable> a,
-                            const std::shared_ptr<Hittable> b)
+bool BVHNode::box_x_compare(const std::shared_ptr<Hittable> &a,
+                            const std::shared_ptr<Hittable> &b)
 {
     return box_compare(a, b, 0);
 }
 
-bool BVHNode::box_y_compare(const std::shared_ptr<Hittable> a,
-                            const std::shared_ptr<Hittable> b)
+bool BVHNode::box_y_compare(const std::shared_ptr<Hittable> &a,
+                            const std::shared_ptr<Hittable> &b)
 {
     return box_compare(a, b, 1);
 }
 
-bool BVHNode::box_z_compare(const std::shared_ptr<Hittable> a,
-                            const std::shared_ptr<Hittable> b)
+bool BVHNode::box_z_compare(const std::shared_ptr<Hittable> &a,
+                            const std::shared_ptr<Hittable> &b)
 {
     return box_compare(a, b, 2);
 }
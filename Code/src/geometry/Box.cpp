@@ -1,100 +1,132 @@
 #include "geometry/Box.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-
-Box::Box(const Vec3 &min, const Vec3 &max, const Vec3 &rotation_deg, std::shared_ptr<Material> mat)
-    : min(min), max(max), rotation(rotation_deg * M_PI / 180.0f), material_ptr(mat)
+Box::Box(const Vec3 &min, const Vec3 &max, const Vec3 &rotation_deg, uint32_t mat)
+    : min(min.min(max)), max(min.max(max)), box_to_world(Transform::rotation(rotation_deg)),
+      world_to_box(box_to_world.inverse()), material_id(mat)
 {
-    Vec3 v0 = min;
-    Vec3 v1 = Vec3(max.x, min.y, min.z);
-    Vec3 v2 = Vec3(max.x, max.y, min.z);
-    Vec3 v3 = Vec3(min.x, max.y, min.z);
-    Vec3 v4 = Vec3(min.x, min.y, max.z);
-    Vec3 v5 = Vec3(max.x, min.y, max.z);
-    Vec3 v6 = max;
-    Vec3 v7 = Vec3(min.x, max.y, max.z);
-
-    v0 = rotatePoint(v0);
-    v1 = rotatePoint(v1);
-    v2 = rotatePoint(v2);
-    v3 = rotatePoint(v3);
-    v4 = rotatePoint(v4);
-    v5 = rotatePoint(v5);
-    v6 = rotatePoint(v6);
-    v7 = rotatePoint(v7);
-
-    triangles.push_back(std::make_shared<Triangle>(v0, v1, v2, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v0, v2, v3, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v1, v5, v6, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v1, v6, v2, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v5, v4, v7, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v5, v7, v6, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v4, v0, v3, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v4, v3, v7, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v3, v2, v6, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v3, v6, v7, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v4, v5, v1, material_ptr));
-    triangles.push_back(std::make_shared<Triangle>(v4, v1, v0, material_ptr));
 }
 
-Vec3 Box::rotatePoint(const Vec3& point) const 
+bool Box::intersect(const Ray &ray, float t_min, float t_max, float &t, int &face) const
 {
-    Vec3 rotated = point;
-    
-    // Rotate around X axis
-    if (rotation.x != 0) {
-        float cosX = cos(rotation.x);
-        float sinX = sin(rotation.x);
-        float y = rotated.y;
-        float z = rotated.z;
-        rotated.y = y * cosX - z * sinX;
-        rotated.z = y * sinX + z * cosX;
+    // Rotations keep lengths, so distances along the ray are the same in the box's frame
+    Vec3 origin = world_to_box.point(ray.origin());
+    Vec3 direction = world_to_box.vector(ray.direction());
+
+    float t_near = -std::numeric_limits<float>::infinity();
+    float t_far = std::numeric_limits<float>::infinity();
+    int near_face = 0;
+    int far_face = 0;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float inv_d = 1.0f / direction[axis];
+        float t0 = (min[axis] - origin[axis]) * inv_d;
+        float t1 = (max[axis] - origin[axis]) * inv_d;
+        int face0 = axis;
+        int face1 = axis + 3;
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+            std::swap(face0, face1);
+        }
+
+        // A ray parallel to a pair of faces and starting on one of them gives NaN, which leaves the interval as is
+        if (t0 > t_near)
+        {
+            t_near = t0;
+            near_face = face0;
+        }
+        if (t1 < t_far)
+        {
+            t_far = t1;
+            far_face = face1;
+        }
     }
-    
-    // Rotate around Y axis
-    if (rotation.y != 0) {
-        float cosY = cos(rotation.y);
-        float sinY = sin(rotation.y);
-        float x = rotated.x;
-        float z = rotated.z;
-        rotated.x = x * cosY + z * sinY;
-        rotated.z = -x * sinY + z * cosY;
+
+    if (t_near > t_far)
+        return false;
+
+    // Rays starting inside the box hit the face they leave through
+    if (t_near >= t_min && t_near <= t_max)
+    {
+        t = t_near;
+        face = near_face;
+        return true;
     }
-    
-    // Rotate around Z axis
-    if (rotation.z != 0) {
-        float cosZ = cos(rotation.z);
-        float sinZ = sin(rotation.z);
-        float x = rotated.x;
-        float y = rotated.y;
-        rotated.x = x * cosZ - y * sinZ;
-        rotated.y = x * sinZ + y * cosZ;
+    if (t_far >= t_min && t_far <= t_max)
+    {
+        t = t_far;
+        face = far_face;
+        return true;
     }
-    
-    return rotated;
+    return false;
 }
 
 bool Box::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
 {
-    HitRecord temp_rec;
-    bool hit_anything = false;
-    double closest_so_far = t_max;
+    float t;
+    int face;
+    if (!intersect(ray, t_min, t_max, t, face))
+        return false;
 
-    for (const auto &triangle : triangles)
+    rec.t = t;
+    rec.primitive = this;
+    rec.hit_u = static_cast<float>(face);
+    return true;
+}
+
+void Box::compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const
+{
+    int face = static_cast<int>(rec.hit_u);
+    int axis = face % 3;
+    float side = face < 3 ? -1.0f : 1.0f;
+    Vec3 local_normal(axis == 0 ? side : 0.0f, axis == 1 ? side : 0.0f, axis == 2 ? side : 0.0f);
+
+    rec.point = ray.at(rec.t);
+    rec.set_face_normal(ray, box_to_world.vector(local_normal));
+    rec.material_id = material_id;
+
+    if (!materials.uses_texture_coordinates(material_id))
     {
-        if (triangle->hit(ray, t_min, closest_so_far, temp_rec))
-        {
-            hit_anything = true;
-            closest_so_far = temp_rec.t;
-            rec = temp_rec;
-        }
+        rec.u = rec.v = 0.0f;
+        return;
     }
 
-    return hit_anything;
+    // The face is parametrised by the two other axes of the box's frame
+    Vec3 local_point = world_to_box.point(rec.point);
+    int u_axis = (axis + 1) % 3;
+    int v_axis = (axis + 2) % 3;
+    float u = (local_point[u_axis] - min[u_axis]) / (max[u_axis] - min[u_axis]);
+    float v = (local_point[v_axis] - min[v_axis]) / (max[v_axis] - min[v_axis]);
+
+    rec.u = std::max(0.0f, std::min(1.0f, u));
+    rec.v = std::max(0.0f, std::min(1.0f, v));
+}
+
+bool Box::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    float t;
+    int face;
+    return intersect(ray, t_min, t_max, t, face);
 }
 
 bool Box::bounding_box(AABB &output_box) const
 {
-    output_box = AABB(min, max);
+    Vec3 lower(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+               std::numeric_limits<float>::infinity());
+    Vec3 upper = -lower;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        Vec3 local((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+        Vec3 world = box_to_world.point(local);
+        lower = lower.min(world);
+        upper = upper.max(world);
+    }
+
+    output_box = AABB(lower, upper);
     return true;
 }
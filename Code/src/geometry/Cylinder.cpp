@@ -2,6 +2,14 @@
 
 #include <cmath>
 
+namespace
+{
+/// Values of HitRecord::hit_u identifying the part of the cylinder that was hit.
+constexpr float kSide = 0.0f;
+constexpr float kBottomCap = 1.0f;
+constexpr float kTopCap = 2.0f;
+} // namespace
+
 bool Cylinder::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
 {
     Vec3 oc = ray.origin() - center;
@@ -14,6 +22,7 @@ bool Cylinder::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) con
     float discriminant = b * b - 4 * a * c;
 
     float closest_t = t_max;
+    float part = kSide;
     bool hit_anything = false;
 
     // Side intersection
@@ -27,23 +36,12 @@ bool Cylinder::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) con
         {
             if (t >= t_min && t <= closest_t)
             {
-                Vec3 hit_point = ray.at(t);
-                float height_proj = (hit_point - center).dot(axis);
+                float height_proj = (ray.at(t) - center).dot(axis);
                 if (std::abs(height_proj) <= height)
                 {
                     closest_t = t;
+                    part = kSide;
                     hit_anything = true;
-                    rec.t = t;
-                    rec.point = hit_point;
-                    Vec3 axis_point = center + height_proj * axis;
-                    rec.normal = (hit_point - axis_point) / radius;
-                    rec.set_face_normal(ray, rec.normal);
-
-                    // Compute texture coordinates for the side
-                    Vec3 from_axis = hit_point - axis_point;
-                    float theta = atan2(from_axis.z, from_axis.x);
-                    rec.u = (theta + M_PI) / (2 * M_PI);
-                    rec.v = (height_proj + height) / (2 * height); // Map height to [0, 1]
                 }
             }
         }
@@ -58,22 +56,13 @@ bool Cylinder::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) con
         float t = (bottom_center - ray.origin()).dot(axis) / denom;
         if (t >= t_min && t <= closest_t)
         {
-            Vec3 hit_point = ray.at(t);
-            Vec3 from_center = hit_point - bottom_center;
+            Vec3 from_center = ray.at(t) - bottom_center;
             float r2 = from_center.dot(from_center) - pow(from_center.dot(axis), 2);
             if (r2 <= radius * radius)
             {
                 closest_t = t;
+                part = kBottomCap;
                 hit_anything = true;
-                rec.t = t;
-                rec.point = hit_point;
-                rec.normal = -axis;
-                rec.set_face_normal(ray, rec.normal);
-
-                // Compute texture coordinates for the bottom cap
-                Vec3 cap_relative = hit_point - bottom_center;
-                rec.u = (cap_relative.x + radius) / (2 * radius);
-                rec.v = (cap_relative.z + radius) / (2 * radius);
             }
         }
 
@@ -82,35 +71,113 @@ bool Cylinder::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) con
         t = (top_center - ray.origin()).dot(axis) / denom;
         if (t >= t_min && t <= closest_t)
         {
-            Vec3 hit_point = ray.at(t);
-            Vec3 from_center = hit_point - top_center;
+            Vec3 from_center = ray.at(t) - top_center;
             float r2 = from_center.dot(from_center) - pow(from_center.dot(axis), 2);
             if (r2 <= radius * radius)
             {
                 closest_t = t;
+                part = kTopCap;
                 hit_anything = true;
-                rec.t = t;
-                rec.point = hit_point;
-                rec.normal = axis;
-                rec.set_face_normal(ray, rec.normal);
-
-                // Compute texture coordinates for the top cap
-                Vec3 cap_relative = hit_point - top_center;
-                rec.u = (cap_relative.x + radius) / (2 * radius);
-                rec.v = (cap_relative.z + radius) / (2 * radius);
             }
         }
     }
 
     if (hit_anything)
     {
-        rec.material_ptr = material_ptr;
+        rec.t = closest_t;
+        rec.primitive = this;
+        rec.hit_u = part;
         return true;
     }
 
     return false;
 }
 
+void Cylinder::compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const
+{
+    rec.point = ray.at(rec.t);
+    rec.material_id = material_id;
+    bool textured = materials.uses_texture_coordinates(material_id);
+
+    if (rec.hit_u == kSide)
+    {
+        float height_proj = (rec.point - center).dot(axis);
+        Vec3 axis_point = center + height_proj * axis;
+        rec.normal = (rec.point - axis_point) / radius;
+        rec.set_face_normal(ray, rec.normal);
+
+        if (textured)
+        {
+            // Compute texture coordinates for the side
+            Vec3 from_axis = rec.point - axis_point;
+            float theta = atan2(from_axis.z, from_axis.x);
+            rec.u = (theta + M_PI) / (2 * M_PI);
+            rec.v = (height_proj + height) / (2 * height); // Map height to [0, 1]
+        }
+    }
+    else
+    {
+        bool top = rec.hit_u == kTopCap;
+        Vec3 cap_center = top ? center + axis * height : center - axis * height;
+        rec.normal = top ? axis : -axis;
+        rec.set_face_normal(ray, rec.normal);
+
+        if (textured)
+        {
+            // Compute texture coordinates for the cap
+            Vec3 cap_relative = rec.point - cap_center;
+            rec.u = (cap_relative.x + radius) / (2 * radius);
+            rec.v = (cap_relative.z + radius) / (2 * radius);
+        }
+    }
+
+    if (!textured)
+        rec.u = rec.v = 0.0f;
+}
+
+bool Cylinder::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    Vec3 oc = ray.origin() - center;
+    Vec3 ray_dir_proj = ray.direction() - ray.direction().dot(axis) * axis;
+    Vec3 oc_proj = oc - oc.dot(axis) * axis;
+
+    float a = ray_dir_proj.dot(ray_dir_proj);
+    float b = 2.0f * oc_proj.dot(ray_dir_proj);
+    float c = oc_proj.dot(oc_proj) - radius * radius;
+    float discriminant = b * b - 4 * a * c;
+
+    // Side
+    if (discriminant >= 0)
+    {
+        float sqrt_disc = sqrt(discriminant);
+        for (float t : {(-b - sqrt_disc) / (2.0f * a), (-b + sqrt_disc) / (2.0f * a)})
+        {
+            if (t >= t_min && t <= t_max && std::abs((ray.at(t) - center).dot(axis)) <= height)
+                return true;
+        }
+    }
+
+    // Caps
+    float denom = ray.direction().dot(axis);
+    if (std::abs(denom) > 1e-6)
+    {
+        for (float side : {-1.0f, 1.0f})
+        {
+            Vec3 cap_center = center + axis * (side * height);
+            float t = (cap_center - ray.origin()).dot(axis) / denom;
+            if (t >= t_min && t <= t_max)
+            {
+                Vec3 from_center = ray.at(t) - cap_center;
+                float r2 = from_center.dot(from_center) - pow(from_center.dot(axis), 2);
+                if (r2 <= radius * radius)
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 bool Cylinder::bounding_box(AABB &output_box) const
 {
     const float padding = 0.0001f; // Small padding to avoid floating point precision issues
@@ -19,6 +19,16 @@ bool HittableList::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec)
     return hit_anything;
 }
 
+bool HittableList::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    for (const auto &object : objects)
+    {
+        if (object->occluded(ray, t_min, t_max))
+            return true;
+    }
+    return false;
+}
+
 bool HittableList::bounding_box(AABB &output_box) const
 {
     if (objects.empty())
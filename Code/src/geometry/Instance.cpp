@@ -0,0 +1,58 @@
+#include "geometry/Instance.h"
+
+#include <algorithm>
+#include <limits>
+
+Instance::Instance(std::shared_ptr<const Hittable> prototype, const Transform &object_to_world)
+    : prototype(std::move(prototype)), object_to_world(object_to_world),
+      world_to_object(object_to_world.inverse())
+{
+    AABB box;
+    bounded = this->prototype->bounding_box(box);
+    if (!bounded)
+        return;
+
+    Vec3 minimum(std::numeric_limits<float>::infinity());
+    Vec3 maximum(-std::numeric_limits<float>::infinity());
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        Vec3 p(corner & 1 ? box.maximum.x : box.minimum.x,
+               corner & 2 ? box.maximum.y : box.minimum.y,
+               corner & 4 ? box.maximum.z : box.minimum.z);
+        Vec3 q = object_to_world.point(p);
+        minimum = Vec3(std::min(minimum.x, q.x), std::min(minimum.y, q.y), std::min(minimum.z, q.z));
+        maximum = Vec3(std::max(maximum.x, q.x), std::max(maximum.y, q.y), std::max(maximum.z, q.z));
+    }
+    world_bounds = AABB(minimum, maximum);
+}
+
+bool Instance::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
+{
+    if (!prototype->hit(to_object(ray), t_min, t_max, rec))
+        return false;
+
+    rec.instanced_primitive = rec.primitive;
+    rec.primitive = this;
+    return true;
+}
+
+void Instance::compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const
+{
+    rec.primitive = rec.instanced_primitive;
+    rec.primitive->compute_interaction(to_object(ray), rec, materials);
+
+    // Normals transform by the inverse transpose, so that they stay perpendicular to scaled surfaces
+    rec.point = ray.at(rec.t);
+    rec.normal = world_to_object.transposed_vector(rec.normal).normalized();
+}
+
+bool Instance::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    return prototype->occluded(to_object(ray), t_min, t_max);
+}
+
+bool Instance::bounding_box(AABB &output_box) const
+{
+    output_box = world_bounds;
+    return bounded;
+}
@@ -0,0 +1,706 @@
+#include "geometry/LinearBVH.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @struct LinearBVH::BuildNode
+ * @brief Intermediate node used while building. Children are referenced by index into the node pool,
+ *        so subtrees can be built concurrently and flattened into depth-first order afterwards.
+ */
+struct LinearBVH::BuildNode
+{
+    AABB bounds;
+    int32_t children[2] = {-1, -1};
+    int32_t first_prim = 0;
+    uint16_t n_prims = 0;
+    uint8_t axis = 0;
+};
+
+/**
+ * @struct LinearBVH::BuildContext
+ * @brief State shared by every build task: the cached primitives, partitioned in place, and a node
+ *        pool sized for the worst case so tasks can allocate nodes with a single atomic increment.
+ */
+struct LinearBVH::BuildContext
+{
+    std::vector<BuildPrimitive> prims;
+    std::vector<BuildNode> pool;
+    std::atomic<int> used{0};
+
+    int allocate(int count) { return used.fetch_add(count, std::memory_order_relaxed); }
+};
+
+namespace
+{
+/// Ranges larger than this are handed to a separate OpenMP task.
+constexpr size_t kParallelBuildThreshold = 4096;
+
+/// Depth from which ranges are split at their median. Halving reaches a leaf within log2(n) <= 32 more levels,
+/// so no input can grow a tree past LinearBVH::kMaxDepth.
+constexpr int kMedianSplitDepth = LinearBVH::kMaxDepth / 2;
+
+/// Number of high Morton bits shared by all primitives in an HLBVH treelet.
+constexpr int kTreeletBits = 12;
+
+/// Deepest an HLBVH treelet root can lie under the upper tree, which splits by SAH down to depth kTreeletBits
+/// and then halves its at most 2^kTreeletBits roots.
+constexpr int kTreeletRootDepth = 2 * kTreeletBits;
+
+/// Number of bits per axis in a 63-bit Morton code.
+constexpr int kMortonBitsPerAxis = 21;
+
+struct MortonPrimitive
+{
+    uint64_t code;
+    uint32_t index;
+};
+
+/**
+ * Spreads the low 21 bits of v so that there are two zero bits between each of them.
+ */
+uint64_t expand_bits(uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+/**
+ * Interleaves three coordinates in [0, 1] into a 63-bit Morton code, with x in the highest bit of each triple.
+ */
+uint64_t morton_code(const Vec3 &p)
+{
+    const float scale = static_cast<float>(1 << kMortonBitsPerAxis);
+    auto quantise = [scale](float f)
+    { return static_cast<uint64_t>(std::min(std::max(f * scale, 0.0f), scale - 1.0f)); };
+    return (expand_bits(quantise(p.x)) << 2) | (expand_bits(quantise(p.y)) << 1) | expand_bits(quantise(p.z));
+}
+
+/**
+ * Sorts Morton primitives by code with a least-significant-digit radix sort.
+ * Each pass builds per-thread histograms so the scatter can run in parallel.
+ */
+void radix_sort(std::vector<MortonPrimitive> &items)
+{
+    constexpr int kBitsPerPass = 8;
+    constexpr int kBuckets = 1 << kBitsPerPass;
+    constexpr int kPasses = (3 * kMortonBitsPerAxis + kBitsPerPass - 1) / kBitsPerPass;
+
+    std::vector<MortonPrimitive> scratch(items.size());
+    int n_threads = 1;
+#ifdef _OPENMP
+    n_threads = omp_get_max_threads();
+#endif
+    std::vector<size_t> offsets(static_cast<size_t>(n_threads) * kBuckets);
+    const long long n = static_cast<long long>(items.size());
+
+    for (int pass = 0; pass < kPasses; ++pass)
+    {
+        int shift = pass * kBitsPerPass;
+        std::fill(offsets.begin(), offsets.end(), 0);
+
+#pragma omp parallel num_threads(n_threads)
+        {
+            int t = 0;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+#endif
+            long long chunk_begin = n * t / n_threads;
+            long long chunk_end = n * (t + 1) / n_threads;
+            size_t *histogram = &offsets[static_cast<size_t>(t) * kBuckets];
+
+            for (long long i = chunk_begin; i < chunk_end; ++i)
+                histogram[(items[i].code >> shift) & (kBuckets - 1)]++;
+
+#pragma omp barrier
+#pragma omp single
+            {
+                // Exclusive prefix sum in (bucket, thread) order keeps the sort stable
+                size_t sum = 0;
+                for (int b = 0; b < kBuckets; ++b)
+                    for (int th = 0; th < n_threads; ++th)
+                    {
+                        size_t count = offsets[static_cast<size_t>(th) * kBuckets + b];
+                        offsets[static_cast<size_t>(th) * kBuckets + b] = sum;
+                        sum += count;
+                    }
+            }
+
+            for (long long i = chunk_begin; i < chunk_end; ++i)
+                scratch[histogram[(items[i].code >> shift) & (kBuckets - 1)]++] = items[i];
+        }
+        items.swap(scratch);
+    }
+}
+} // namespace
+
+LinearBVH::LinearBVH(const std::vector<std::shared_ptr<Hittable>> &objects,
+                     BVHBuilder builder,
+                     int max_prims_in_node)
+    : builder(builder), max_prims_in_node(std::min(max_prims_in_node, 65535))
+{
+    if (objects.empty())
+        return;
+
+    const long long n = static_cast<long long>(objects.size());
+    BuildContext ctx;
+    ctx.prims.resize(objects.size());
+    ctx.pool.resize(2 * objects.size() - 1);
+
+#pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        if (!objects[i]->bounding_box(ctx.prims[i].bounds))
+            std::cerr << "No bounding box in LinearBVH constructor.\n";
+        ctx.prims[i].centroid = ctx.prims[i].bounds.centroid();
+        ctx.prims[i].index = static_cast<size_t>(i);
+    }
+
+    int root;
+    if (builder == BVHBuilder::LBVH || builder == BVHBuilder::HLBVH)
+    {
+        root = build_morton(ctx);
+    }
+    else
+    {
+        root = ctx.allocate(1);
+#pragma omp parallel
+#pragma omp single
+        build_top_down(ctx, root, 0, ctx.prims.size(), 0);
+    }
+
+    // Leaves reference ranges of the partitioned primitive array, so its order is the final primitive order
+    primitives.resize(objects.size());
+#pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+        primitives[i] = objects[ctx.prims[i].index];
+
+    node_storage.reserve(ctx.used.load());
+    flatten(ctx, root);
+    nodes = node_storage.data();
+    n_nodes = node_storage.size();
+    pack_leaves();
+}
+
+LinearBVH::LinearBVH(const std::vector<std::shared_ptr<Hittable>> &objects,
+                     const LinearBVHNode *nodes, size_t node_count, const uint32_t *primitive_order,
+                     std::shared_ptr<const void> storage)
+    : builder(BVHBuilder::SAH), max_prims_in_node(0), nodes(nodes), n_nodes(node_count),
+      adopted_storage(std::move(storage))
+{
+    primitives.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+        primitives[i] = objects[primitive_order[i]];
+    pack_leaves();
+}
+
+void LinearBVH::pack_leaves()
+{
+    std::vector<std::pair<int32_t, int>> leaves;
+    for (size_t i = 0; i < n_nodes; ++i)
+    {
+        if (nodes[i].n_primitives > 0)
+            leaves.emplace_back(nodes[i].primitives_offset, nodes[i].n_primitives);
+    }
+    packets.build(primitives, leaves);
+}
+
+bool LinearBVH::make_leaf(BuildContext &ctx, int node_index, size_t start, size_t end, const AABB &bounds) const
+{
+    size_t span = end - start;
+    if (span > 65535)
+        return false;
+
+    BuildNode &leaf = ctx.pool[node_index];
+    leaf.bounds = bounds;
+    leaf.first_prim = static_cast<int32_t>(start);
+    leaf.n_prims = static_cast<uint16_t>(span);
+    return true;
+}
+
+void LinearBVH::build_top_down(BuildContext &ctx, int node_index, size_t start, size_t end, int depth)
+{
+    std::vector<BuildPrimitive> &build_prims = ctx.prims;
+
+    AABB bounds = build_prims[start].bounds;
+    AABB centroid_bounds(build_prims[start].centroid, build_prims[start].centroid);
+    for (size_t i = start + 1; i < end; ++i)
+    {
+        bounds = AABB::surrounding_box(bounds, build_prims[i].bounds);
+        centroid_bounds = AABB::surrounding_box(centroid_bounds, AABB(build_prims[i].centroid, build_prims[i].centroid));
+    }
+
+    // Split along the axis with the widest spread of centroids
+    Vec3 extent = centroid_bounds.maximum - centroid_bounds.minimum;
+    int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+
+    size_t span = end - start;
+    bool leaf = extent[axis] <= 0.0f;
+    size_t mid = start + span / 2;
+
+    if (!leaf && builder == BVHBuilder::SAH && depth < kMedianSplitDepth)
+    {
+        leaf = !partition_sah(build_prims, start, end, bounds, centroid_bounds, mid, axis, max_prims_in_node);
+    }
+    else if (!leaf)
+    {
+        leaf = span <= static_cast<size_t>(max_prims_in_node);
+        if (!leaf)
+        {
+            // Partition around the median centroid
+            std::nth_element(build_prims.begin() + start, build_prims.begin() + mid, build_prims.begin() + end,
+                             [axis](const BuildPrimitive &a, const BuildPrimitive &b)
+                             { return a.centroid[axis] < b.centroid[axis]; });
+        }
+    }
+
+    if (leaf && make_leaf(ctx, node_index, start, end, bounds))
+        return;
+
+    int children = ctx.allocate(2);
+    BuildNode &interior = ctx.pool[node_index];
+    interior.bounds = bounds;
+    interior.children[0] = children;
+    interior.children[1] = children + 1;
+    interior.axis = static_cast<uint8_t>(axis);
+
+#pragma omp task shared(ctx) if (mid - start > kParallelBuildThreshold)
+    build_top_down(ctx, children, start, mid, depth + 1);
+#pragma omp task shared(ctx) if (end - mid > kParallelBuildThreshold)
+    build_top_down(ctx, children + 1, mid, end, depth + 1);
+}
+
+bool LinearBVH::partition_sah(std::vector<BuildPrimitive> &build_prims, size_t start, size_t end,
+                              const AABB &bounds, const AABB &centroid_bounds, size_t &mid, int &axis,
+                              int max_leaf_size) const
+{
+    struct Bin
+    {
+        AABB bounds;
+        int count = 0;
+    };
+
+    size_t span = end - start;
+    float leaf_cost = kIntersectionCost * span;
+    float inv_area = 1.0f / std::max(bounds.surface_area(), 1e-12f);
+
+    float best_cost = std::numeric_limits<float>::infinity();
+    int best_axis = -1;
+    int best_split = 0;
+
+    for (int a = 0; a < 3; ++a)
+    {
+        float cmin = centroid_bounds.minimum[a];
+        float cextent = centroid_bounds.maximum[a] - cmin;
+        if (cextent <= 0.0f)
+            continue;
+
+        Bin bins[kSAHBins];
+        float scale = kSAHBins / cextent;
+        for (size_t i = start; i < end; ++i)
+        {
+            int b = std::min(kSAHBins - 1, static_cast<int>((build_prims[i].centroid[a] - cmin) * scale));
+            bins[b].bounds = bins[b].count == 0 ? build_prims[i].bounds
+                                                : AABB::surrounding_box(bins[b].bounds, build_prims[i].bounds);
+            bins[b].count++;
+        }
+
+        // Sweep from the right to get the area and count above each candidate plane
+        float right_area[kSAHBins - 1];
+        int right_count[kSAHBins - 1];
+        AABB right_box;
+        int count = 0;
+        for (int b = kSAHBins - 1; b > 0; --b)
+        {
+            if (bins[b].count > 0)
+            {
+                right_box = count == 0 ? bins[b].bounds : AABB::surrounding_box(right_box, bins[b].bounds);
+                count += bins[b].count;
+            }
+            right_area[b - 1] = count > 0 ? right_box.surface_area() : 0.0f;
+            right_count[b - 1] = count;
+        }
+
+        // Sweep from the left and evaluate the cost of splitting after each bin
+        AABB left_box;
+        count = 0;
+        for (int b = 0; b < kSAHBins - 1; ++b)
+        {
+            if (bins[b].count > 0)
+            {
+                left_box = count == 0 ? bins[b].bounds : AABB::surrounding_box(left_box, bins[b].bounds);
+                count += bins[b].count;
+            }
+            if (count == 0 || right_count[b] == 0)
+                continue;
+
+            float cost = kTraversalCost +
+                         kIntersectionCost * (count * left_box.surface_area() + right_count[b] * right_area[b]) * inv_area;
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = a;
+                best_split = b;
+            }
+        }
+    }
+
+    if (best_axis < 0)
+    {
+        // Every centroid coincides; only split if the range cannot fit in one leaf
+        if (span <= 65535)
+            return false;
+        mid = start + span / 2;
+        return true;
+    }
+
+    if (span <= static_cast<size_t>(max_leaf_size) && leaf_cost <= best_cost)
+        return false;
+
+    float cmin = centroid_bounds.minimum[best_axis];
+    float scale = kSAHBins / (centroid_bounds.maximum[best_axis] - cmin);
+    auto split = std::partition(build_prims.begin() + start, build_prims.begin() + end,
+                                [=](const BuildPrimitive &p)
+                                {
+                                    int b = std::min(kSAHBins - 1, static_cast<int>((p.centroid[best_axis] - cmin) * scale));
+                                    return b <= best_split;
+                                });
+
+    mid = static_cast<size_t>(split - build_prims.begin());
+    axis = best_axis;
+    if (mid == start || mid == end)
+    {
+        // Bins collapsed due to floating point error, fall back to an even split
+        mid = start + span / 2;
+        std::nth_element(build_prims.begin() + start, build_prims.begin() + mid, build_prims.begin() + end,
+                         [best_axis](const BuildPrimitive &a, const BuildPrimitive &b)
+                         { return a.centroid[best_axis] < b.centroid[best_axis]; });
+    }
+    return true;
+}
+
+int LinearBVH::build_morton(BuildContext &ctx)
+{
+    const long long n = static_cast<long long>(ctx.prims.size());
+
+    AABB centroid_bounds(ctx.prims[0].centroid, ctx.prims[0].centroid);
+    for (const auto &prim : ctx.prims)
+        centroid_bounds = AABB::surrounding_box(centroid_bounds, AABB(prim.centroid, prim.centroid));
+    Vec3 extent = centroid_bounds.maximum - centroid_bounds.minimum;
+    Vec3 inv_extent(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                    extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                    extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+    std::vector<MortonPrimitive> morton(ctx.prims.size());
+#pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        Vec3 offset = (ctx.prims[i].centroid - centroid_bounds.minimum) * inv_extent;
+        morton[i].code = morton_code(offset);
+        morton[i].index = static_cast<uint32_t>(i);
+    }
+    radix_sort(morton);
+
+    // Reorder the cached primitives into Morton order so leaves can reference contiguous ranges
+    std::vector<BuildPrimitive> sorted(ctx.prims.size());
+    std::vector<uint64_t> codes(ctx.prims.size());
+#pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; ++i)
+    {
+        sorted[i] = ctx.prims[morton[i].index];
+        codes[i] = morton[i].code;
+    }
+    ctx.prims.swap(sorted);
+
+    const int top_bit = 3 * kMortonBitsPerAxis - 1;
+    if (builder == BVHBuilder::LBVH)
+    {
+        int root = ctx.allocate(1);
+#pragma omp parallel
+#pragma omp single
+        build_morton_range(ctx, codes, root, 0, ctx.prims.size(), top_bit, 0);
+        return root;
+    }
+
+    // HLBVH: split the sorted primitives into treelets that share their top Morton bits,
+    // build every treelet in parallel, then join the treelet roots with an SAH-built upper tree
+    const int treelet_shift = 3 * kMortonBitsPerAxis - kTreeletBits;
+    std::vector<size_t> treelet_starts;
+    for (size_t i = 0; i < codes.size(); ++i)
+    {
+        if (i == 0 || (codes[i] >> treelet_shift) != (codes[i - 1] >> treelet_shift))
+            treelet_starts.push_back(i);
+    }
+    treelet_starts.push_back(codes.size());
+
+    const long long n_treelets = static_cast<long long>(treelet_starts.size()) - 1;
+    std::vector<int> treelet_roots(n_treelets);
+    for (long long t = 0; t < n_treelets; ++t)
+        treelet_roots[t] = ctx.allocate(1);
+
+#pragma omp parallel
+#pragma omp single
+    for (long long t = 0; t < n_treelets; ++t)
+    {
+#pragma omp task shared(ctx, codes, treelet_starts, treelet_roots)
+        build_morton_range(ctx, codes, treelet_roots[t], treelet_starts[t], treelet_starts[t + 1], treelet_shift - 1,
+                           kTreeletRootDepth);
+    }
+
+    return build_upper_sah(ctx, treelet_roots, 0, treelet_roots.size(), 0);
+}
+
+AABB LinearBVH::build_morton_range(BuildContext &ctx, const std::vector<uint64_t> &codes,
+                                   int node_index, size_t start, size_t end, int bit, int depth)
+{
+    size_t span = end - start;
+
+    // Find the highest bit at which the first and last code of the range differ
+    while (bit >= 0 && ((codes[start] >> bit) & 1) == ((codes[end - 1] >> bit) & 1))
+        --bit;
+
+    if (span <= static_cast<size_t>(max_prims_in_node) || bit < 0)
+    {
+        AABB bounds = ctx.prims[start].bounds;
+        for (size_t i = start + 1; i < end; ++i)
+            bounds = AABB::surrounding_box(bounds, ctx.prims[i].bounds);
+        if (make_leaf(ctx, node_index, start, end, bounds))
+            return bounds;
+    }
+
+    size_t mid;
+    int axis;
+    if (bit >= 0 && depth < kMedianSplitDepth)
+    {
+        // Codes are sorted, so the first one with the bit set starts the second half
+        mid = std::partition_point(codes.begin() + start, codes.begin() + end,
+                                   [bit](uint64_t code)
+                                   { return ((code >> bit) & 1) == 0; }) -
+              codes.begin();
+        axis = 2 - bit % 3;
+    }
+    else
+    {
+        mid = start + span / 2;
+        axis = 0;
+    }
+
+    int children = ctx.allocate(2);
+    AABB child_bounds[2];
+
+#pragma omp task shared(ctx, codes, child_bounds) if (mid - start > kParallelBuildThreshold)
+    child_bounds[0] = build_morton_range(ctx, codes, children, start, mid, bit - 1, depth + 1);
+#pragma omp task shared(ctx, codes, child_bounds) if (end - mid > kParallelBuildThreshold)
+    child_bounds[1] = build_morton_range(ctx, codes, children + 1, mid, end, bit - 1, depth + 1);
+#pragma omp taskwait
+
+    BuildNode &interior = ctx.pool[node_index];
+    interior.bounds = AABB::surrounding_box(child_bounds[0], child_bounds[1]);
+    interior.children[0] = children;
+    interior.children[1] = children + 1;
+    interior.axis = static_cast<uint8_t>(axis);
+    return interior.bounds;
+}
+
+int LinearBVH::build_upper_sah(BuildContext &ctx, std::vector<int> &roots, size_t start, size_t end, int depth)
+{
+    if (end - start == 1)
+        return roots[start];
+
+    AABB bounds = ctx.pool[roots[start]].bounds;
+    AABB centroid_bounds(bounds.centroid(), bounds.centroid());
+    for (size_t i = start + 1; i < end; ++i)
+    {
+        const AABB &b = ctx.pool[roots[i]].bounds;
+        bounds = AABB::surrounding_box(bounds, b);
+        centroid_bounds = AABB::surrounding_box(centroid_bounds, AABB(b.centroid(), b.centroid()));
+    }
+
+    // Reuse the primitive SAH partitioning by treating every treelet as a single primitive
+    std::vector<BuildPrimitive> treelets(end - start);
+    for (size_t i = start; i < end; ++i)
+    {
+        treelets[i - start].bounds = ctx.pool[roots[i]].bounds;
+        treelets[i - start].centroid = treelets[i - start].bounds.centroid();
+        treelets[i - start].index = static_cast<size_t>(roots[i]);
+    }
+
+    size_t mid = treelets.size() / 2;
+    int axis = 0;
+    if (depth >= kTreeletBits ||
+        !partition_sah(treelets, 0, treelets.size(), bounds, centroid_bounds, mid, axis, 1) || mid == 0)
+        mid = treelets.size() / 2;
+    for (size_t i = 0; i < treelets.size(); ++i)
+        roots[start + i] = static_cast<int>(treelets[i].index);
+    mid += start;
+
+    int node_index = ctx.allocate(1);
+    int left = build_upper_sah(ctx, roots, start, mid, depth + 1);
+    int right = build_upper_sah(ctx, roots, mid, end, depth + 1);
+
+    BuildNode &interior = ctx.pool[node_index];
+    interior.bounds = bounds;
+    interior.children[0] = left;
+    interior.children[1] = right;
+    interior.axis = static_cast<uint8_t>(axis);
+    return node_index;
+}
+
+int LinearBVH::flatten(const BuildContext &ctx, int build_index)
+{
+    const BuildNode &build_node = ctx.pool[build_index];
+    int node_index = static_cast<int>(node_storage.size());
+    node_storage.emplace_back();
+
+    if (build_node.n_prims > 0)
+    {
+        LinearBVHNode &leaf = node_storage[node_index];
+        leaf.bounds = build_node.bounds;
+        leaf.primitives_offset = build_node.first_prim;
+        leaf.n_primitives = build_node.n_prims;
+        leaf.axis = 0;
+        return node_index;
+    }
+
+    flatten(ctx, build_node.children[0]);
+    int second_child = flatten(ctx, build_node.children[1]);
+
+    LinearBVHNode &interior = node_storage[node_index];
+    interior.bounds = build_node.bounds;
+    interior.second_child_offset = second_child;
+    interior.n_primitives = 0;
+    interior.axis = build_node.axis;
+    return node_index;
+}
+
+float LinearBVH::sah_cost() const
+{
+    if (n_nodes == 0)
+        return 0.0f;
+
+    float inv_root_area = 1.0f / std::max(nodes[0].bounds.surface_area(), 1e-12f);
+    float cost = 0.0f;
+    for (size_t i = 0; i < n_nodes; ++i)
+    {
+        const LinearBVHNode &node = nodes[i];
+        float relative_area = node.bounds.surface_area() * inv_root_area;
+        cost += relative_area * (node.n_primitives > 0 ? kIntersectionCost * node.n_primitives : kTraversalCost);
+    }
+    return cost;
+}
+
+bool LinearBVH::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
+{
+    if (n_nodes == 0)
+        return false;
+
+    Vec3 origin = ray.origin();
+    Vec3 direction = ray.direction();
+    Vec3 inv_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    const bool dir_is_neg[3] = {inv_direction.x < 0.0f, inv_direction.y < 0.0f, inv_direction.z < 0.0f};
+    WatertightRay watertight(ray);
+
+    bool hit_anything = false;
+    int stack[kMaxDepth];
+    int stack_size = 0;
+    int current = 0;
+
+    while (true)
+    {
+        const LinearBVHNode &node = nodes[current];
+        if (node.bounds.hit(origin, inv_direction, t_min, t_max))
+        {
+            if (node.n_primitives > 0)
+            {
+                if (packets.hit(primitives.data(), node.primitives_offset, node.n_primitives, ray, watertight,
+                                t_min, t_max, rec))
+                {
+                    hit_anything = true;
+                    t_max = rec.t;
+                }
+                if (stack_size == 0)
+                    break;
+                current = stack[--stack_size];
+            }
+            else if (dir_is_neg[node.axis])
+            {
+                // The second child lies nearer along the split axis, visit it first
+                stack[stack_size++] = current + 1;
+                current = node.second_child_offset;
+            }
+            else
+            {
+                stack[stack_size++] = node.second_child_offset;
+                current = current + 1;
+            }
+        }
+        else
+        {
+            if (stack_size == 0)
+                break;
+            current = stack[--stack_size];
+        }
+    }
+
+    return hit_anything;
+}
+
+bool LinearBVH::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    if (n_nodes == 0)
+        return false;
+
+    Vec3 origin = ray.origin();
+    Vec3 direction = ray.direction();
+    Vec3 inv_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    WatertightRay watertight(ray);
+
+    // Any intersection ends the query, so children are visited in array order
+    int stack[kMaxDepth];
+    int stack_size = 0;
+    int current = 0;
+
+    while (true)
+    {
+        const LinearBVHNode &node = nodes[current];
+        if (node.bounds.hit(origin, inv_direction, t_min, t_max))
+        {
+            if (node.n_primitives > 0)
+            {
+                if (packets.occluded(primitives.data(), node.primitives_offset, node.n_primitives, ray, watertight,
+                                     t_min, t_max))
+                    return true;
+            }
+            else
+            {
+                stack[stack_size++] = node.second_child_offset;
+                current = current + 1;
+                continue;
+            }
+        }
+
+        if (stack_size == 0)
+            return false;
+        current = stack[--stack_size];
+    }
+}
+
+bool LinearBVH::bounding_box(AABB &output_box) const
+{
+    if (n_nodes == 0)
+        return false;
+
+    output_box = nodes[0].bounds;
+    return true;
+}
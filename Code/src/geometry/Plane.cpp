@@ -16,29 +16,30 @@ bool Plane::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
         return false;
 
     rec.t = t;
-    rec.point = ray.at(t);
+    rec.primitive = this;
+    return true;
+}
+
+void Plane::compute_interaction(const Ray &ray, HitRecord &rec, [[maybe_unused]] const MaterialTable &materials) const
+{
+    rec.point = ray.at(rec.t);
     rec.set_face_normal(ray, normal);
-    rec.material_ptr = material_ptr;
+    rec.material_id = material_id;
+    rec.u = rec.v = 0.0f; // Planes have no texture parameterisation
+}
 
-    return true;
+bool Plane::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    float denom = normal.dot(ray.direction());
+    if (fabs(denom) < 1e-6)
+        return false;
+
+    float t = (point - ray.origin()).dot(normal) / denom;
+    return t >= t_min && t <= t_max;
 }
 
-bool Plane::bounding_box(AABB &output_box) const
+bool Plane::bounding_box([[maybe_unused]] AABB &output_box) const
 {
-    // Planes are infinite, need special handling
-    // Create a large but finite box
-    float huge = 1000000.0f;
-    Vec3 min_point = Vec3(-huge, -0.001f, -huge); // Small thickness in normal direction
-    Vec3 max_point = Vec3(huge, 0.001f, huge);
-
-    // Transform based on plane orientation
-    if (normal.y < 0.99f)
-    {
-        // Handle non-horizontal planes
-        min_point = Vec3(-huge, -huge, -huge);
-        max_point = Vec3(huge, huge, huge);
-    }
-
-    output_box = AABB(min_point, max_point);
-    return true;
+    // Planes are infinite; hierarchies keep them out of their BVH and test them separately
+    return false;
 }
@@ -1,53 +1,93 @@
 #include "geometry/Rectangle.h"
 
+#include <algorithm>
+#include <cmath>
+
+Rectangle::Rectangle(
+    const Vec3 &v0,
+    const Vec3 &v1,
+    [[maybe_unused]] const Vec3 &v2,
+    const Vec3 &v3,
+    uint32_t mat)
+    : corner(v0), edge_u(v1 - v0), edge_v(v3 - v0), material_id(mat)
+{
+    Vec3 n = edge_u.cross(edge_v);
+    normal = n.normalized();
+    w = n / n.dot(n);
+    offset = normal.dot(corner);
+}
+
+bool Rectangle::intersect(const Ray &ray, float t_min, float t_max, float &t, float &alpha, float &beta) const
+{
+    float denom = normal.dot(ray.direction());
+    if (std::fabs(denom) < 1e-8f)
+        return false;
+
+    t = (offset - normal.dot(ray.origin())) / denom;
+    if (t < t_min || t > t_max)
+        return false;
+
+    // Coordinates of the point in the plane along the two edges
+    Vec3 p = ray.at(t) - corner;
+    alpha = w.dot(p.cross(edge_v));
+    beta = w.dot(edge_u.cross(p));
+    return alpha >= 0.0f && alpha <= 1.0f && beta >= 0.0f && beta <= 1.0f;
+}
+
 bool Rectangle::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
 {
-    HitRecord temp_rec;
-    bool hit_anything = false;
-    float closest_so_far = t_max;
+    float t, alpha, beta;
+    if (!intersect(ray, t_min, t_max, t, alpha, beta))
+        return false;
+
+    rec.t = t;
+    rec.primitive = this;
+    rec.hit_u = alpha;
+    rec.hit_v = beta;
+    return true;
+}
+
+void Rectangle::compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const
+{
+    rec.point = ray.at(rec.t);
+    rec.set_face_normal(ray, normal);
+    rec.material_id = material_id;
 
-    for (const auto &triangle : triangles)
+    if (!materials.uses_texture_coordinates(material_id))
     {
-        if (triangle->hit(ray, t_min, closest_so_far, temp_rec))
-        {
-            hit_anything = true;
-            closest_so_far = temp_rec.t;
-            rec = temp_rec;
-            closest_so_far = rec.t;
-        }
+        rec.u = rec.v = 0.0f;
+        return;
     }
 
-    return hit_anything;
+    rec.u = rec.hit_u;
+    rec.v = rec.hit_v;
 }
 
-bool Rectangle::bounding_box(AABB &output_box) const
+bool Rectangle::occluded(const Ray &ray, float t_min, float t_max) const
 {
-    AABB box0, box1;
-
-    if (!triangles[0]->bounding_box(box0) || !triangles[1]->bounding_box(box1))
-        return false;
-
-    Vec3 small(fmin(box0.minimum.x, box1.minimum.x),
-               fmin(box0.minimum.y, box1.minimum.y),
-               fmin(box0.minimum.z, box1.minimum.z));
+    float t, alpha, beta;
+    return intersect(ray, t_min, t_max, t, alpha, beta);
+}
 
-    Vec3 big(fmax(box0.maximum.x, box1.maximum.x),
-             fmax(box0.maximum.y, box1.maximum.y),
-             fmax(box0.maximum.z, box1.maximum.z));
+bool Rectangle::bounding_box(AABB &output_box) const
+{
+    Vec3 opposite = corner + edge_u + edge_v;
+    Vec3 small = corner.min(corner + edge_u).min(corner + edge_v).min(opposite);
+    Vec3 big = corner.max(corner + edge_u).max(corner + edge_v).max(opposite);
 
     // Add a small padding to prevent zero-thickness boxes
     const float padding = 0.0001f;
-    if (abs(big.x - small.x) < padding)
+    if (std::fabs(big.x - small.x) < padding)
     {
         small.x -= padding;
         big.x += padding;
     }
-    if (abs(big.y - small.y) < padding)
+    if (std::fabs(big.y - small.y) < padding)
     {
         small.y -= padding;
         big.y += padding;
     }
-    if (abs(big.z - small.z) < padding)
+    if (std::fabs(big.z - small.z) < padding)
     {
         small.z -= padding;
         big.z += padding;
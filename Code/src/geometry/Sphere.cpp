@@ -27,10 +27,22 @@ bool Sphere::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
     }
 
     rec.t = root;
+    rec.primitive = this;
+    return true;
+}
+
+void Sphere::compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const
+{
     rec.point = ray.at(rec.t);
     Vec3 outward_normal = (rec.point - centre) / radius;
     rec.set_face_normal(ray, outward_normal);
-    rec.material_ptr = material_ptr;
+    rec.material_id = material_id;
+
+    if (!materials.uses_texture_coordinates(material_id))
+    {
+        rec.u = rec.v = 0.0f;
+        return;
+    }
 
     // Compute texture coordinates
     Vec3 p = (rec.point - centre).normalized(); // Normalized to sphere surface
@@ -38,8 +50,24 @@ bool Sphere::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
     float phi = atan2(-p.z, p.x) + M_PI;        // Angle around Y-axis (horizontal)
     rec.u = phi / (2 * M_PI);                   // Map phi to [0, 1]
     rec.v = theta / M_PI;                       // Map theta to [0, 1]
+}
 
-    return true;
+bool Sphere::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    Vec3 oc = ray.origin() - centre;
+    float a = ray.direction().dot(ray.direction());
+    float b = 2.0 * oc.dot(ray.direction());
+    float c = oc.dot(oc) - radius * radius;
+
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant < 0)
+        return false;
+
+    float sqrt_discriminant = std::sqrt(discriminant);
+    float near_root = (-b - sqrt_discriminant) / (2.0 * a);
+    float far_root = (-b + sqrt_discriminant) / (2.0 * a);
+
+    return (near_root >= t_min && near_root <= t_max) || (far_root >= t_min && far_root <= t_max);
 }
 
 bool Sphere::bounding_box(AABB &output_box) const
@@ -0,0 +1,54 @@
+#include "geometry/SplitHierarchy.h"
+
+void SplitHierarchy::partition(const std::vector<std::shared_ptr<Hittable>> &objects,
+                               std::vector<std::shared_ptr<Hittable>> &bounded,
+                               std::vector<std::shared_ptr<Hittable>> &unbounded)
+{
+    bounded.reserve(bounded.size() + objects.size());
+    AABB box;
+    for (const auto &object : objects)
+    {
+        if (object->bounding_box(box))
+            bounded.push_back(object);
+        else
+            unbounded.push_back(object);
+    }
+}
+
+bool SplitHierarchy::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
+{
+    bool hit_anything = false;
+    float closest_so_far = t_max;
+
+    // Primitives only write the record on a hit closer than the interval's end, so it can be shared
+    for (const auto &object : unbounded)
+    {
+        if (object->hit(ray, t_min, closest_so_far, rec))
+        {
+            hit_anything = true;
+            closest_so_far = rec.t;
+        }
+    }
+
+    if (bounded && bounded->hit(ray, t_min, closest_so_far, rec))
+        hit_anything = true;
+
+    return hit_anything;
+}
+
+bool SplitHierarchy::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    for (const auto &object : unbounded)
+    {
+        if (object->occluded(ray, t_min, t_max))
+            return true;
+    }
+    return bounded && bounded->occluded(ray, t_min, t_max);
+}
+
+bool SplitHierarchy::bounding_box(AABB &output_box) const
+{
+    if (!unbounded.empty() || !bounded)
+        return false;
+    return bounded->bounding_box(output_box);
+}
@@ -0,0 +1,134 @@
+#include "geometry/TriangleMesh.h"
+#include "geometry/TrianglePacket.h"
+
+#include <cmath>
+
+void TriangleMesh::use_owned_buffers()
+{
+    positions = owned_positions.data();
+    normals = owned_normals.empty() ? nullptr : owned_normals.data();
+    uvs = owned_uvs.empty() ? nullptr : owned_uvs.data();
+    indices = owned_indices.data();
+    vertex_count = static_cast<uint32_t>(owned_positions.size());
+    faces = static_cast<uint32_t>(owned_indices.size() / 3);
+}
+
+void TriangleMesh::create_faces(const TriangleMesh &mesh, std::vector<std::shared_ptr<Hittable>> &objects)
+{
+    auto block = std::make_shared<std::vector<MeshTriangle>>();
+    block->reserve(mesh.face_count());
+    for (uint32_t face = 0; face < mesh.face_count(); ++face)
+        block->emplace_back(&mesh, face);
+
+    // Aliasing pointers share the block's single control block instead of allocating one per face
+    objects.reserve(objects.size() + mesh.face_count());
+    for (MeshTriangle &triangle : *block)
+        objects.push_back(std::shared_ptr<Hittable>(block, &triangle));
+}
+
+bool MeshTriangle::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
+{
+    const uint32_t *index = &mesh->indices[3 * face];
+    const Vec3 &vertex0 = mesh->positions[index[0]];
+    const Vec3 &vertex1 = mesh->positions[index[1]];
+    const Vec3 &vertex2 = mesh->positions[index[2]];
+
+    float t, b1, b2;
+    if (!intersect_watertight(WatertightRay(ray), vertex0, vertex1, vertex2, t_min, t_max, t, b1, b2))
+        return false;
+
+    rec.t = t;
+    rec.primitive = this;
+    rec.hit_u = b1;
+    rec.hit_v = b2;
+    return true;
+}
+
+void MeshTriangle::compute_interaction(const Ray &ray, HitRecord &rec, const MaterialTable &materials) const
+{
+    const uint32_t *index = &mesh->indices[3 * face];
+    const Vec3 &vertex0 = mesh->positions[index[0]];
+    const Vec3 &vertex1 = mesh->positions[index[1]];
+    const Vec3 &vertex2 = mesh->positions[index[2]];
+
+    // Barycentric weights of the three vertices, from the coordinates recorded by hit()
+    float b1 = rec.hit_u;
+    float b2 = rec.hit_v;
+    float b0 = 1.0f - b1 - b2;
+
+    rec.point = ray.at(rec.t);
+    rec.material_id = mesh->material_id;
+
+    Vec3 face_normal = (vertex1 - vertex0).cross(vertex2 - vertex0).normalized();
+    Vec3 normal = face_normal;
+    if (mesh->normals)
+    {
+        Vec3 shading = mesh->normals[index[0]] * b0 + mesh->normals[index[1]] * b1 + mesh->normals[index[2]] * b2;
+        // Degenerate interpolated normals (opposing vertex normals) fall back to the face normal
+        if (shading.length() > 1e-6f)
+        {
+            normal = shading.normalized();
+            // Orient the shading normal with the winding so front/back classification matches the geometry
+            if (normal.dot(face_normal) < 0.0f)
+                normal = -normal;
+        }
+    }
+    rec.normal = normal;
+    rec.set_face_normal(ray, normal);
+
+    if (!materials.uses_texture_coordinates(mesh->material_id))
+    {
+        rec.u = rec.v = 0.0f;
+        return;
+    }
+
+    if (!mesh->uvs)
+    {
+        // Without texture coordinates, the barycentrics parameterise the face
+        rec.u = b1;
+        rec.v = b2;
+        return;
+    }
+
+    const float *uv0 = &mesh->uvs[2 * index[0]];
+    const float *uv1 = &mesh->uvs[2 * index[1]];
+    const float *uv2 = &mesh->uvs[2 * index[2]];
+    rec.u = uv0[0] * b0 + uv1[0] * b1 + uv2[0] * b2;
+    rec.v = uv0[1] * b0 + uv1[1] * b1 + uv2[1] * b2;
+}
+
+bool MeshTriangle::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    const uint32_t *index = &mesh->indices[3 * face];
+    const Vec3 &vertex0 = mesh->positions[index[0]];
+    const Vec3 &vertex1 = mesh->positions[index[1]];
+    const Vec3 &vertex2 = mesh->positions[index[2]];
+
+    float t, b1, b2;
+    return intersect_watertight(WatertightRay(ray), vertex0, vertex1, vertex2, t_min, t_max, t, b1, b2);
+}
+
+bool MeshTriangle::bounding_box(AABB &output_box) const
+{
+    const uint32_t *index = &mesh->indices[3 * face];
+    const Vec3 &vertex0 = mesh->positions[index[0]];
+    const Vec3 &vertex1 = mesh->positions[index[1]];
+    const Vec3 &vertex2 = mesh->positions[index[2]];
+
+    Vec3 min(
+        std::min(std::min(vertex0.x, vertex1.x), vertex2.x),
+        std::min(std::min(vertex0.y, vertex1.y), vertex2.y),
+        std::min(std::min(vertex0.z, vertex1.z), vertex2.z));
+    Vec3 max(
+        std::max(std::max(vertex0.x, vertex1.x), vertex2.x),
+        std::max(std::max(vertex0.y, vertex1.y), vertex2.y),
+        std::max(std::max(vertex0.z, vertex1.z), vertex2.z));
+
+    // Add a small epsilon to avoid zero-size bounding boxes
+    const float epsilon = 1e-5f;
+    min = min - Vec3(epsilon, epsilon, epsilon);
+    max = max + Vec3(epsilon, epsilon, epsilon);
+
+    output_box = AABB(min, max);
+    return true;
+}
@@ -0,0 +1,259 @@
+#include "geometry/TrianglePacket.h"
+
+#include <limits>
+
+#if defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+/**
+ * Tests a ray against the triangles of a packet one lane at a time. Used when the target has no suitable vector
+ * unit. Writes each lane's distance and barycentric coordinates and returns a bit mask of the lanes that were hit.
+ */
+template <int Lanes>
+inline unsigned intersect_packet(const TrianglePacket<Lanes> &packet, const WatertightRay &ray, float t_min,
+                                 float t_max, float *t, float *b1, float *b2)
+{
+    unsigned mask = 0;
+    for (int i = 0; i < Lanes; ++i)
+    {
+        Vec3 v[3];
+        for (int k = 0; k < 3; ++k)
+            v[k] = Vec3(packet.vertices[k][0][i], packet.vertices[k][1][i], packet.vertices[k][2][i]);
+        if (intersect_watertight(ray, v[0], v[1], v[2], t_min, t_max, t[i], b1[i], b2[i]))
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+#if defined(__SSE__)
+/**
+ * SSE watertight test of four triangles, evaluating the same expressions as intersect_watertight so that both
+ * agree exactly, including the double-precision recomputation of lanes with a zero edge function. NaN lanes fail
+ * every ordered comparison.
+ */
+template <>
+inline unsigned intersect_packet<4>(const TrianglePacket<4> &packet, const WatertightRay &ray, float t_min,
+                                    float t_max, float *t, float *b1, float *b2)
+{
+    const __m128 sx = _mm_set1_ps(ray.sx);
+    const __m128 sy = _mm_set1_ps(ray.sy);
+    const __m128 sz = _mm_set1_ps(ray.sz);
+    __m128 x[3], y[3], z[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        __m128 px = _mm_sub_ps(_mm_load_ps(packet.vertices[k][ray.kx]), _mm_set1_ps(ray.origin[ray.kx]));
+        __m128 py = _mm_sub_ps(_mm_load_ps(packet.vertices[k][ray.ky]), _mm_set1_ps(ray.origin[ray.ky]));
+        __m128 pz = _mm_sub_ps(_mm_load_ps(packet.vertices[k][ray.kz]), _mm_set1_ps(ray.origin[ray.kz]));
+        x[k] = _mm_sub_ps(px, _mm_mul_ps(sx, pz));
+        y[k] = _mm_sub_ps(py, _mm_mul_ps(sy, pz));
+        z[k] = pz;
+    }
+
+    __m128 e0 = _mm_sub_ps(_mm_mul_ps(x[2], y[1]), _mm_mul_ps(y[2], x[1]));
+    __m128 e1 = _mm_sub_ps(_mm_mul_ps(x[0], y[2]), _mm_mul_ps(y[0], x[2]));
+    __m128 e2 = _mm_sub_ps(_mm_mul_ps(x[1], y[0]), _mm_mul_ps(y[1], x[0]));
+
+    const __m128 zero = _mm_setzero_ps();
+    __m128 zero_edge = _mm_or_ps(_mm_or_ps(_mm_cmpeq_ps(e0, zero), _mm_cmpeq_ps(e1, zero)), _mm_cmpeq_ps(e2, zero));
+    if (unsigned lanes = static_cast<unsigned>(_mm_movemask_ps(zero_edge)))
+    {
+        alignas(16) float xs[3][4], ys[3][4], es[3][4];
+        for (int k = 0; k < 3; ++k)
+        {
+            _mm_store_ps(xs[k], x[k]);
+            _mm_store_ps(ys[k], y[k]);
+        }
+        _mm_store_ps(es[0], e0);
+        _mm_store_ps(es[1], e1);
+        _mm_store_ps(es[2], e2);
+        for (; lanes; lanes &= lanes - 1)
+        {
+            int i = __builtin_ctz(lanes);
+            watertight_edges_double(xs[0][i], ys[0][i], xs[1][i], ys[1][i], xs[2][i], ys[2][i],
+                                    es[0][i], es[1][i], es[2][i]);
+        }
+        e0 = _mm_load_ps(es[0]);
+        e1 = _mm_load_ps(es[1]);
+        e2 = _mm_load_ps(es[2]);
+    }
+
+    __m128 none_negative = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+    __m128 none_positive = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(e0, zero), _mm_cmple_ps(e1, zero)), _mm_cmple_ps(e2, zero));
+    __m128 det = _mm_add_ps(_mm_add_ps(e0, e1), e2);
+    __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(e0, sz), z[0]), _mm_mul_ps(_mm_mul_ps(e1, sz), z[1])),
+                                 _mm_mul_ps(_mm_mul_ps(e2, sz), z[2]));
+    distance = _mm_mul_ps(distance, inv_det);
+
+    __m128 mask = _mm_and_ps(_mm_or_ps(none_negative, none_positive), _mm_cmpneq_ps(det, zero));
+    mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(distance, _mm_set1_ps(t_min)), _mm_cmple_ps(distance, _mm_set1_ps(t_max))));
+
+    _mm_storeu_ps(t, distance);
+    _mm_storeu_ps(b1, _mm_mul_ps(e1, inv_det));
+    _mm_storeu_ps(b2, _mm_mul_ps(e2, inv_det));
+    return static_cast<unsigned>(_mm_movemask_ps(mask));
+}
+#endif
+} // namespace
+
+void LeafPackets::build(const std::vector<std::shared_ptr<Hittable>> &primitives,
+                        const std::vector<std::pair<int32_t, int>> &leaves)
+{
+    constexpr int Lanes = kTrianglePacketLanes;
+    const long long n_leaves = static_cast<long long>(leaves.size());
+    std::vector<Vec3> vertices(3 * primitives.size());
+    std::vector<int32_t> packet_counts(n_leaves);
+
+    // A leaf is packed only if every primitive in it is a triangle; -1 marks the others and 0 single triangles
+#pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n_leaves; ++i)
+    {
+        int32_t first = leaves[i].first;
+        bool triangles = true;
+        for (int k = 0; k < leaves[i].second && triangles; ++k)
+        {
+            Vec3 *v = &vertices[3 * (first + k)];
+            triangles = primitives[first + k]->triangle_vertices(v[0], v[1], v[2]);
+        }
+        if (triangles)
+            packet_counts[i] = leaves[i].second == 1 ? 0 : (leaves[i].second + Lanes - 1) / Lanes;
+        else
+            packet_counts[i] = -1;
+    }
+
+    // A single triangle would fill one lane of a packet and spread its vertices over three cache lines
+    leaf_data.assign(primitives.size(), -1);
+    int32_t n_packets = 0, n_singles = 0;
+    for (long long i = 0; i < n_leaves; ++i)
+    {
+        if (packet_counts[i] == 0)
+            leaf_data[leaves[i].first] = 3 * n_singles++;
+        else if (packet_counts[i] > 0)
+        {
+            leaf_data[leaves[i].first] = n_packets;
+            n_packets += packet_counts[i];
+        }
+    }
+    packets.assign(n_packets, TrianglePacket<Lanes>());
+    singles.resize(3 * n_singles);
+
+    // Transpose each leaf's vertices into its packets, padding the last one with NaN triangles
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+#pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n_leaves; ++i)
+    {
+        int32_t first = leaves[i].first;
+        if (packet_counts[i] == 0)
+        {
+            for (int j = 0; j < 3; ++j)
+                singles[leaf_data[first] + j] = vertices[3 * first + j];
+        }
+        for (int p = 0; p < packet_counts[i]; ++p)
+        {
+            TrianglePacket<Lanes> &packet = packets[leaf_data[first] + p];
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                int k = p * Lanes + lane;
+                for (int j = 0; j < 3; ++j)
+                {
+                    Vec3 v = k < leaves[i].second ? vertices[3 * (first + k) + j] : Vec3(nan, nan, nan);
+                    packet.vertices[j][0][lane] = v.x;
+                    packet.vertices[j][1][lane] = v.y;
+                    packet.vertices[j][2][lane] = v.z;
+                }
+            }
+        }
+    }
+}
+
+bool LeafPackets::hit(const std::shared_ptr<Hittable> *primitives, int32_t first, int count, const Ray &ray,
+                      const WatertightRay &watertight, float t_min, float t_max, HitRecord &rec) const
+{
+    constexpr int Lanes = kTrianglePacketLanes;
+    bool hit_anything = false;
+
+    if (leaf_data.empty() || leaf_data[first] < 0)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (primitives[first + i]->hit(ray, t_min, t_max, rec))
+            {
+                hit_anything = true;
+                t_max = rec.t;
+            }
+        }
+        return hit_anything;
+    }
+
+    if (count == 1)
+    {
+        const Vec3 *v = &singles[leaf_data[first]];
+        float t, b1, b2;
+        if (!intersect_watertight(watertight, v[0], v[1], v[2], t_min, t_max, t, b1, b2))
+            return false;
+
+        rec.t = t;
+        rec.primitive = primitives[first].get();
+        rec.hit_u = b1;
+        rec.hit_v = b2;
+        return true;
+    }
+
+    const TrianglePacket<Lanes> *leaf = &packets[leaf_data[first]];
+    for (int base = 0; base < count; base += Lanes, ++leaf)
+    {
+        alignas(16) float t[Lanes], b1[Lanes], b2[Lanes];
+        unsigned mask = intersect_packet(*leaf, watertight, t_min, t_max, t, b1, b2);
+        while (mask)
+        {
+            int lane = __builtin_ctz(mask);
+            mask &= mask - 1;
+            if (t[lane] > t_max)
+                continue;
+
+            hit_anything = true;
+            t_max = t[lane];
+            rec.t = t[lane];
+            rec.primitive = primitives[first + base + lane].get();
+            rec.hit_u = b1[lane];
+            rec.hit_v = b2[lane];
+        }
+    }
+    return hit_anything;
+}
+
+bool LeafPackets::occluded(const std::shared_ptr<Hittable> *primitives, int32_t first, int count, const Ray &ray,
+                           const WatertightRay &watertight, float t_min, float t_max) const
+{
+    constexpr int Lanes = kTrianglePacketLanes;
+
+    if (leaf_data.empty() || leaf_data[first] < 0)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (primitives[first + i]->occluded(ray, t_min, t_max))
+                return true;
+        }
+        return false;
+    }
+
+    if (count == 1)
+    {
+        const Vec3 *v = &singles[leaf_data[first]];
+        float t, b1, b2;
+        return intersect_watertight(watertight, v[0], v[1], v[2], t_min, t_max, t, b1, b2);
+    }
+
+    const TrianglePacket<Lanes> *leaf = &packets[leaf_data[first]];
+    for (int base = 0; base < count; base += Lanes, ++leaf)
+    {
+        alignas(16) float t[Lanes], b1[Lanes], b2[Lanes];
+        if (intersect_packet(*leaf, watertight, t_min, t_max, t, b1, b2))
+            return true;
+    }
+    return false;
+}
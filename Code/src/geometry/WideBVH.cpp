@@ -0,0 +1,396 @@
+#include "geometry/WideBVH.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+/**
+ * Per-ray data shared by every slab test. For each axis the near plane is the child minimum when the
+ * direction is positive and the maximum when it is negative, so the bounds rows to read are fixed per ray.
+ */
+struct SlabRay
+{
+    float origin[3];
+    float inv_direction[3];
+    int near_row[3];
+    int far_row[3];
+    float t_min;
+};
+
+/**
+ * An entry of the traversal stack: a child slot copied out of its parent together with its entry distance.
+ */
+struct StackEntry
+{
+    float t_near;
+    int32_t child;
+    uint16_t count;
+};
+
+/**
+ * Tests all children of a node one at a time. Used when the target has no suitable vector unit.
+ * Writes each child's entry distance to t_near and returns a bit mask of the children that were hit.
+ */
+template <int Width>
+inline unsigned intersect_children_scalar(const WideBVHNode<Width> &node, const SlabRay &ray,
+                                          float t_max, float *t_near)
+{
+    unsigned mask = 0;
+    for (int i = 0; i < Width; ++i)
+    {
+        float t0 = ray.t_min;
+        float t1 = t_max;
+        for (int a = 0; a < 3; ++a)
+        {
+            float near_t = (node.bounds[ray.near_row[a]][i] - ray.origin[a]) * ray.inv_direction[a];
+            float far_t = (node.bounds[ray.far_row[a]][i] - ray.origin[a]) * ray.inv_direction[a];
+            t0 = near_t > t0 ? near_t : t0;
+            t1 = far_t < t1 ? far_t : t1;
+        }
+        t_near[i] = t0;
+        mask |= static_cast<unsigned>(t0 <= t1) << i;
+    }
+    return mask;
+}
+
+template <int Width>
+inline unsigned intersect_children(const WideBVHNode<Width> &node, const SlabRay &ray, float t_max, float *t_near)
+{
+    return intersect_children_scalar(node, ray, t_max, t_near);
+}
+
+#if defined(__SSE__)
+/**
+ * SSE slab test of the four children of a node. max/min take the running value as the second operand
+ * so that a NaN from a zero direction component and a ray origin on a slab plane is ignored.
+ */
+template <>
+inline unsigned intersect_children<4>(const WideBVHNode<4> &node, const SlabRay &ray, float t_max, float *t_near)
+{
+    __m128 t0 = _mm_set1_ps(ray.t_min);
+    __m128 t1 = _mm_set1_ps(t_max);
+    for (int a = 0; a < 3; ++a)
+    {
+        __m128 origin = _mm_set1_ps(ray.origin[a]);
+        __m128 inv_direction = _mm_set1_ps(ray.inv_direction[a]);
+        __m128 near_t = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.near_row[a]]), origin), inv_direction);
+        __m128 far_t = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.far_row[a]]), origin), inv_direction);
+        t0 = _mm_max_ps(near_t, t0);
+        t1 = _mm_min_ps(far_t, t1);
+    }
+    _mm_storeu_ps(t_near, t0);
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(t0, t1)));
+}
+#endif
+
+#if defined(__AVX__)
+/**
+ * AVX slab test of the eight children of a node, with the same NaN handling as the SSE version.
+ */
+template <>
+inline unsigned intersect_children<8>(const WideBVHNode<8> &node, const SlabRay &ray, float t_max, float *t_near)
+{
+    __m256 t0 = _mm256_set1_ps(ray.t_min);
+    __m256 t1 = _mm256_set1_ps(t_max);
+    for (int a = 0; a < 3; ++a)
+    {
+        __m256 origin = _mm256_set1_ps(ray.origin[a]);
+        __m256 inv_direction = _mm256_set1_ps(ray.inv_direction[a]);
+        __m256 near_t = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[ray.near_row[a]]), origin), inv_direction);
+        __m256 far_t = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[ray.far_row[a]]), origin), inv_direction);
+        t0 = _mm256_max_ps(near_t, t0);
+        t1 = _mm256_min_ps(far_t, t1);
+    }
+    _mm256_storeu_ps(t_near, t0);
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(t0, t1, _CMP_LE_OQ)));
+}
+#endif
+/**
+ * Checks that a ray's origin is finite and its direction has no NaN components.
+ */
+inline bool finite_ray(const Vec3 &origin, const Vec3 &direction)
+{
+    for (int a = 0; a < 3; ++a)
+        if (!std::isfinite(origin[a]) || std::isnan(direction[a]))
+            return false;
+    return true;
+}
+} // namespace
+
+template <int Width>
+WideBVH<Width>::WideBVH(const std::vector<std::shared_ptr<Hittable>> &objects,
+                        BVHBuilder builder,
+                        int max_prims_in_node)
+{
+    if (objects.empty())
+        return;
+
+    LinearBVH binary(objects, builder, max_prims_in_node);
+    const LinearBVHNode *binary_nodes = binary.flattened_nodes();
+
+    root_bounds = binary_nodes[0].bounds;
+    binary_sah_cost = binary.sah_cost();
+    primitives = binary.ordered_primitives();
+    // Collapsing keeps the binary hierarchy's leaves, so their packets carry over
+    packets = binary.take_leaf_packets();
+
+    // Every wide node absorbs at least one binary interior node, so this is an upper bound
+    node_storage.reserve(binary.node_count() / 2 + 1);
+    collapse(binary_nodes, 0);
+    nodes = node_storage.data();
+    n_nodes = node_storage.size();
+}
+
+template <int Width>
+WideBVH<Width>::WideBVH(const std::vector<std::shared_ptr<Hittable>> &objects,
+                        const WideBVHNode<Width> *nodes, size_t node_count, const uint32_t *primitive_order,
+                        float sah_cost, std::shared_ptr<const void> storage)
+    : binary_sah_cost(sah_cost), nodes(nodes), n_nodes(node_count), adopted_storage(std::move(storage))
+{
+    primitives.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+        primitives[i] = objects[primitive_order[i]];
+
+    if (node_count == 0)
+        return;
+
+    // The root's bounds are the union of its children's
+    const WideBVHNode<Width> &root = nodes[0];
+    Vec3 minimum(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+    Vec3 maximum = -minimum;
+    for (int i = 0; i < Width; ++i)
+    {
+        if (root.children[i] < 0)
+            continue;
+        minimum = Vec3(std::min(minimum.x, root.bounds[0][i]), std::min(minimum.y, root.bounds[1][i]), std::min(minimum.z, root.bounds[2][i]));
+        maximum = Vec3(std::max(maximum.x, root.bounds[3][i]), std::max(maximum.y, root.bounds[4][i]), std::max(maximum.z, root.bounds[5][i]));
+    }
+    root_bounds = AABB(minimum, maximum);
+
+    std::vector<std::pair<int32_t, int>> leaves;
+    for (size_t n = 0; n < node_count; ++n)
+    {
+        for (int i = 0; i < Width; ++i)
+        {
+            if (nodes[n].counts[i] > 0)
+                leaves.emplace_back(nodes[n].children[i], nodes[n].counts[i]);
+        }
+    }
+    packets.build(primitives, leaves);
+}
+
+template <int Width>
+int WideBVH<Width>::collapse(const LinearBVHNode *binary, int binary_index)
+{
+    int slots[Width];
+    int n_slots = 1;
+    slots[0] = binary_index;
+
+    // Open the interior child with the largest surface area until the node is full
+    while (n_slots < Width)
+    {
+        int best = -1;
+        float best_area = -1.0f;
+        for (int i = 0; i < n_slots; ++i)
+        {
+            const LinearBVHNode &candidate = binary[slots[i]];
+            if (candidate.n_primitives == 0 && candidate.bounds.surface_area() > best_area)
+            {
+                best = i;
+                best_area = candidate.bounds.surface_area();
+            }
+        }
+        if (best < 0)
+            break;
+
+        int opened = slots[best];
+        slots[best] = opened + 1;
+        slots[n_slots++] = binary[opened].second_child_offset;
+    }
+
+    int node_index = static_cast<int>(node_storage.size());
+    node_storage.emplace_back();
+
+    for (int i = 0; i < Width; ++i)
+    {
+        WideBVHNode<Width> &node = node_storage[node_index];
+        if (i >= n_slots)
+        {
+            // An inverted box fails the slab test for every ray
+            for (int a = 0; a < 3; ++a)
+            {
+                node.bounds[a][i] = std::numeric_limits<float>::infinity();
+                node.bounds[a + 3][i] = -std::numeric_limits<float>::infinity();
+            }
+            node.children[i] = -1;
+            node.counts[i] = 0;
+            continue;
+        }
+
+        const LinearBVHNode &child = binary[slots[i]];
+        for (int a = 0; a < 3; ++a)
+        {
+            node.bounds[a][i] = child.bounds.minimum[a];
+            node.bounds[a + 3][i] = child.bounds.maximum[a];
+        }
+        if (child.n_primitives > 0)
+        {
+            node.children[i] = child.primitives_offset;
+            node.counts[i] = child.n_primitives;
+        }
+        else
+        {
+            // The recursion may grow the node array, so the reference above is re-fetched each iteration
+            int child_index = collapse(binary, slots[i]);
+            node_storage[node_index].children[i] = child_index;
+            node_storage[node_index].counts[i] = 0;
+        }
+    }
+
+    return node_index;
+}
+
+template <int Width>
+bool WideBVH<Width>::hit(const Ray &ray, float t_min, float t_max, HitRecord &rec) const
+{
+    if (n_nodes == 0)
+        return false;
+
+    Vec3 origin = ray.origin();
+    Vec3 direction = ray.direction();
+    // Empty slots have inverted bounds that only a NaN slab distance can pass, since the slab tests ignore NaN
+    if (!finite_ray(origin, direction))
+        return false;
+
+    SlabRay slab_ray;
+    for (int a = 0; a < 3; ++a)
+    {
+        slab_ray.origin[a] = origin[a];
+        slab_ray.inv_direction[a] = 1.0f / direction[a];
+        bool negative = slab_ray.inv_direction[a] < 0.0f;
+        slab_ray.near_row[a] = negative ? a + 3 : a;
+        slab_ray.far_row[a] = negative ? a : a + 3;
+    }
+    slab_ray.t_min = t_min;
+    WatertightRay watertight(ray);
+
+    bool hit_anything = false;
+    // Each visited node replaces one entry with at most Width, over at most the binary BVH's depth
+    StackEntry stack[LinearBVH::kMaxDepth * (Width - 1) + 1];
+    int stack_size = 0;
+    stack[stack_size++] = {t_min, 0, 0};
+
+    while (stack_size > 0)
+    {
+        StackEntry entry = stack[--stack_size];
+        if (entry.t_near > t_max)
+            continue;
+
+        if (entry.count > 0)
+        {
+            if (packets.hit(primitives.data(), entry.child, entry.count, ray, watertight, t_min, t_max, rec))
+            {
+                hit_anything = true;
+                t_max = rec.t;
+            }
+            continue;
+        }
+
+        const WideBVHNode<Width> &node = nodes[entry.child];
+        alignas(32) float t_near[Width];
+        unsigned mask = intersect_children(node, slab_ray, t_max, t_near);
+        if (mask == 0)
+            continue;
+
+        // Push the hit children farthest first so the nearest one is popped next
+        int first = stack_size;
+        while (mask)
+        {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+
+            StackEntry child = {t_near[i], node.children[i], node.counts[i]};
+            int j = stack_size++;
+            while (j > first && stack[j - 1].t_near < child.t_near)
+            {
+                stack[j] = stack[j - 1];
+                --j;
+            }
+            stack[j] = child;
+        }
+    }
+
+    return hit_anything;
+}
+
+template <int Width>
+bool WideBVH<Width>::occluded(const Ray &ray, float t_min, float t_max) const
+{
+    if (n_nodes == 0)
+        return false;
+
+    Vec3 origin = ray.origin();
+    Vec3 direction = ray.direction();
+    // Empty slots have inverted bounds that only a NaN slab distance can pass, since the slab tests ignore NaN
+    if (!finite_ray(origin, direction))
+        return false;
+
+    SlabRay slab_ray;
+    for (int a = 0; a < 3; ++a)
+    {
+        slab_ray.origin[a] = origin[a];
+        slab_ray.inv_direction[a] = 1.0f / direction[a];
+        bool negative = slab_ray.inv_direction[a] < 0.0f;
+        slab_ray.near_row[a] = negative ? a + 3 : a;
+        slab_ray.far_row[a] = negative ? a : a + 3;
+    }
+    slab_ray.t_min = t_min;
+    WatertightRay watertight(ray);
+
+    // Any intersection ends the query, so hit children are pushed unsorted and t_max never shrinks
+    StackEntry stack[LinearBVH::kMaxDepth * (Width - 1) + 1];
+    int stack_size = 0;
+    stack[stack_size++] = {t_min, 0, 0};
+
+    while (stack_size > 0)
+    {
+        StackEntry entry = stack[--stack_size];
+        if (entry.count > 0)
+        {
+            if (packets.occluded(primitives.data(), entry.child, entry.count, ray, watertight, t_min, t_max))
+                return true;
+            continue;
+        }
+
+        const WideBVHNode<Width> &node = nodes[entry.child];
+        alignas(32) float t_near[Width];
+        unsigned mask = intersect_children(node, slab_ray, t_max, t_near);
+        while (mask)
+        {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            stack[stack_size++] = {t_near[i], node.children[i], node.counts[i]};
+        }
+    }
+
+    return false;
+}
+
+template <int Width>
+bool WideBVH<Width>::bounding_box(AABB &output_box) const
+{
+    if (n_nodes == 0)
+        return false;
+
+    output_box = root_bounds;
+    return true;
+}
+
+template class WideBVH<4>;
+template class WideBVH<8>;
@@ -12,6 +12,7 @@ Vec3 BlinnPhongMaterial::shade(
     const Vec3 &view_dir,
     const std::vector<std::shared_ptr<Light>> &lights,
     const Hittable &scene,
+    const MaterialTable &materials,
     int depth,
     const SceneConfig &config) const
 {
@@ -31,14 +32,14 @@ Vec3 BlinnPhongMaterial::shade(
     // Reflective term
     if (is_reflective && depth > 0)
     {
-        Vec3 reflection = calculateReflection(rec, view_dir, lights, scene, depth, config);
+        Vec3 reflection = calculateReflection(rec, view_dir, lights, scene, materials, depth, config);
         final_color = reflectivity * reflection + (1.0f - reflectivity) * final_color;
     }
 
     // Refractive term
     if (is_refractive && depth > 0)
     {
-        Vec3 refraction = calculateRefraction(rec, view_dir, lights, scene, depth, config);
+        Vec3 refraction = calculateRefraction(rec, view_dir, lights, scene, materials, depth, config);
         final_color = (1.0f - reflectivity) * refraction;
     }
 
@@ -95,10 +96,9 @@ bool BlinnPhongMaterial::isInShadow(
     const Vec3 &light_position) const
 {
     Ray shadow_ray(rec.point + rec.normal * 1e-4f, light_dir);
-    HitRecord shadow_rec;
     float max_distance = (light_position - rec.point).length();
 
-    return scene.hit(shadow_ray, 0.001f, max_distance, shadow_rec);
+    return scene.occluded(shadow_ray, 0.001f, max_distance);
 }
 
 Vec3 BlinnPhongMaterial::calculateReflection(
@@ -106,6 +106,7 @@ Vec3 BlinnPhongMaterial::calculateReflection(
     const Vec3 &view_dir,
     const std::vector<std::shared_ptr<Light>> &lights,
     const Hittable &scene,
+    const MaterialTable &materials,
     int depth,
     const SceneConfig &config) const
 {
@@ -115,9 +116,10 @@ Vec3 BlinnPhongMaterial::calculateReflection(
 
     if (scene.hit(reflect_ray, 0.001f, FLT_MAX, reflection_rec))
     {
+        reflection_rec.primitive->compute_interaction(reflect_ray, reflection_rec, materials);
         Vec3 reflected_view_dir = -reflect_ray.direction().normalized();
-        return reflection_rec.material_ptr->shade(
-            reflection_rec, reflected_view_dir, lights, scene, depth - 1, config);
+        return materials[reflection_rec.material_id].shade(
+            reflection_rec, reflected_view_dir, lights, scene, materials, depth - 1, config);
     }
     else
     {
@@ -130,6 +132,7 @@ Vec3 BlinnPhongMaterial::calculateRefraction(
     const Vec3 &view_dir,
     const std::vector<std::shared_ptr<Light>> &lights,
     const Hittable &scene,
+    const MaterialTable &materials,
     int depth,
     const SceneConfig &config) const
 {
@@ -154,14 +157,15 @@ Vec3 BlinnPhongMaterial::calculateRefraction(
         if (cannot_refract)
         {
             // Total internal reflection
-            Vec3 reflection_color = calculateReflection(rec, view_dir, lights, scene, depth, config);
+            Vec3 reflection_color = calculateReflection(rec, view_dir, lights, scene, materials, depth, config);
             return reflection_color;
         }
         else
         {
+            refraction_rec.primitive->compute_interaction(refract_ray, refraction_rec, materials);
             Vec3 refracted_view_dir = -refract_ray.direction().normalized();
-            refraction_color = refraction_rec.material_ptr->shade(
-                refraction_rec, refracted_view_dir, lights, scene, depth - 1, config);
+            refraction_color = materials[refraction_rec.material_id].shade(
+                refraction_rec, refracted_view_dir, lights, scene, materials, depth - 1, config);
         }
     }
     else
@@ -169,7 +173,7 @@ Vec3 BlinnPhongMaterial::calculateRefraction(
         refraction_color = calculateBackgroundColor(refract_ray.direction(), config);
     }
 
-    Vec3 reflection_color = calculateReflection(rec, view_dir, lights, scene, depth, config);
+    Vec3 reflection_color = calculateReflection(rec, view_dir, lights, scene, materials, depth, config);
 
     return fresnel * reflection_color + (1.0f - fresnel) * refraction_color;
 }
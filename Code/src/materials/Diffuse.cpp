@@ -4,15 +4,10 @@ bool Diffuse::scatter([[maybe_unused]] const Ray &ray_in,
                       const HitRecord &rec,
                       ScatterRecord &scatter_rec) const
 {
-    // Cosine-weighted hemisphere sampling
-    Vec3 scatter_direction = rec.normal + random_unit_vector();
-    if (scatter_direction.near_zero())
-    {
-        scatter_direction = rec.normal;
-    }
+    // Cosine-weighted hemisphere sampling is done by the PDF
     scatter_rec.specular_ray = false;
     scatter_rec.attenuation = m_albedo;
-    scatter_rec.pdf_ptr = std::make_shared<CosinePDF>(rec.normal);
+    scatter_rec.pdf = CosinePDF(rec.normal);
     return true;
 }
 
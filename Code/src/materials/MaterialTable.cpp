@@ -0,0 +1,9 @@
+#include "materials/MaterialTable.h"
+#include "materials/Material.h"
+
+uint32_t MaterialTable::add(std::shared_ptr<Material> material)
+{
+    texture_coordinates.push_back(material->uses_texture_coordinates());
+    materials.push_back(std::move(material));
+    return static_cast<uint32_t>(materials.size() - 1);
+}
@@ -0,0 +1,216 @@
+#include "scene/BVHCache.h"
+#include "scene/SceneBinary.h"
+#include "geometry/AABB.h"
+#include "geometry/LinearBVH.h"
+#include "geometry/WideBVH.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+    /// Number of objects hashed together by one thread.
+    constexpr size_t kHashChunk = 1 << 16;
+
+    /**
+     * @brief Folds a 64-bit value into a running hash.
+     */
+    inline uint64_t hash_combine(uint64_t hash, uint64_t value)
+    {
+        hash ^= value * 0x87c37b91114253d5ull;
+        hash = (hash << 31) | (hash >> 33);
+        return hash * 0x4cf5ad432745937full;
+    }
+
+    /**
+     * @brief Spreads every input bit over the whole hash.
+     */
+    inline uint64_t hash_finish(uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        return hash ^ (hash >> 33);
+    }
+
+    /**
+     * @brief Returns the bit pattern of a float, so the key changes with any change of a bound.
+     */
+    inline uint64_t float_bits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    /**
+     * @brief Returns the description stored with an entry, naming the key it was built for.
+     */
+    std::string entry_description(uint64_t key)
+    {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+        return nlohmann::json{{"bvh_cache_key", hex}}.dump();
+    }
+
+    /**
+     * @brief Removes the least recently used entries of the cache directory, oldest first, until the directory
+     *        fits in bvh_cache_max_mb. The entry just stored is kept even if it alone exceeds the limit.
+     *        Renders that still have a removed entry mapped keep reading it until they unmap it.
+     */
+    void evict_least_recent(const std::string &keep, const SceneConfig &config)
+    {
+        if (config.bvh_cache_max_mb <= 0)
+            return;
+        const uint64_t limit = static_cast<uint64_t>(config.bvh_cache_max_mb) << 20;
+
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type used;
+            uint64_t size;
+        };
+        std::vector<Entry> entries;
+        uint64_t total = 0;
+        std::error_code error;
+        for (std::filesystem::directory_iterator it(config.bvh_cache_dir, error), end; !error && it != end;
+             it.increment(error))
+        {
+            if (it->path().extension() != ".rtbin")
+                continue;
+            std::error_code entry_error;
+            uint64_t size = it->file_size(entry_error);
+            auto used = it->last_write_time(entry_error);
+            if (entry_error)
+                continue;
+            total += size;
+            if (it->path() != keep)
+                entries.push_back({it->path(), used, size});
+        }
+        if (total <= limit)
+            return;
+
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.used < b.used; });
+        size_t evicted = 0;
+        uint64_t freed = 0;
+        for (const Entry &entry : entries)
+        {
+            if (total <= limit)
+                break;
+            if (!std::filesystem::remove(entry.path, error) || error)
+                continue;
+            total -= entry.size;
+            freed += entry.size;
+            ++evicted;
+        }
+        if (evicted > 0)
+            std::cout << "BVH cache evicted " << evicted << " least recently used entries, " << freed << " bytes"
+                      << std::endl;
+    }
+}
+
+constexpr size_t BVHCache::kMinObjects;
+
+uint64_t BVHCache::bounds_key(const std::vector<std::shared_ptr<Hittable>> &objects)
+{
+    const long long chunks = static_cast<long long>((objects.size() + kHashChunk - 1) / kHashChunk);
+    std::vector<uint64_t> chunk_hashes(chunks);
+
+#pragma omp parallel for schedule(static)
+    for (long long c = 0; c < chunks; ++c)
+    {
+        size_t end = std::min(objects.size(), static_cast<size_t>(c + 1) * kHashChunk);
+        uint64_t hash = static_cast<uint64_t>(c);
+        for (size_t i = static_cast<size_t>(c) * kHashChunk; i < end; ++i)
+        {
+            AABB box;
+            bool bounded = objects[i]->bounding_box(box);
+            hash = hash_combine(hash, bounded);
+            for (int a = 0; a < 3; ++a)
+                hash = hash_combine(hash, float_bits(box.minimum[a]) << 32 | float_bits(box.maximum[a]));
+        }
+        chunk_hashes[c] = hash;
+    }
+
+    // The chunk hashes are combined in order, so the key does not depend on the thread count
+    uint64_t key = hash_combine(0, objects.size());
+    for (uint64_t hash : chunk_hashes)
+        key = hash_combine(key, hash);
+    return hash_finish(key);
+}
+
+uint64_t BVHCache::geometry_key(const std::vector<std::shared_ptr<Hittable>> &objects, const SceneConfig &config)
+{
+    uint64_t key = hash_combine(0, SceneBinary::kVersion);
+    key = hash_combine(key, static_cast<uint64_t>(config.bvh_width));
+    key = hash_combine(key, static_cast<uint64_t>(config.bvh_builder));
+    key = hash_combine(key, config.bvh_width == 2 ? sizeof(LinearBVHNode)
+                            : config.bvh_width == 4 ? sizeof(WideBVHNode<4>) : sizeof(WideBVHNode<8>));
+    key = hash_combine(key, bounds_key(objects));
+    return hash_finish(key);
+}
+
+std::string BVHCache::entry_path(uint64_t key, const SceneConfig &config)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.rtbin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(config.bvh_cache_dir) / name).string();
+}
+
+std::shared_ptr<Hittable> BVHCache::load(uint64_t key, const std::vector<std::shared_ptr<Hittable>> &objects,
+                                         const SceneConfig &config)
+{
+    std::string path = entry_path(key, config);
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error))
+        return nullptr;
+
+    auto entry = SceneBinary::open(path);
+    if (!entry || entry->description() != entry_description(key))
+        return nullptr;
+    std::shared_ptr<Hittable> root = entry->adopt_bvh(objects, config);
+
+    // Eviction goes by modification time, so a hit makes the entry the most recently used
+    if (root)
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    return root;
+}
+
+uint64_t BVHCache::store(uint64_t key, const Hittable &root, const std::vector<std::shared_ptr<Hittable>> &objects,
+                         const SceneConfig &config)
+{
+    std::error_code error;
+    std::filesystem::create_directories(config.bvh_cache_dir, error);
+    if (error)
+    {
+        std::cerr << "Warning: Cannot create BVH cache directory '" << config.bvh_cache_dir << "': "
+                  << error.message() << std::endl;
+        return 0;
+    }
+
+    std::string path = entry_path(key, config);
+    std::string temporary = path + ".tmp";
+    uint64_t size = SceneBinary::write_bvh_file(temporary, entry_description(key), root, objects, config);
+    if (size == 0)
+    {
+        std::filesystem::remove(temporary, error);
+        return 0;
+    }
+
+    // Renaming replaces an existing entry without disturbing renders that still have it mapped
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+    {
+        std::cerr << "Warning: Cannot store BVH cache entry '" << path << "': " << error.message() << std::endl;
+        std::filesystem::remove(temporary, error);
+        return 0;
+    }
+    evict_least_recent(path, config);
+    return size;
+}
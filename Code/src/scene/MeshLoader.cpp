@@ -0,0 +1,571 @@
+#include "scene/MeshLoader.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+    /// Position, texture coordinate and normal indices of one OBJ face corner; -1 where absent.
+    using ObjCorner = std::array<int, 3>;
+
+    struct ObjCornerHash
+    {
+        size_t operator()(const ObjCorner &c) const
+        {
+            uint64_t h = static_cast<uint32_t>(c[0]);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(c[1]);
+            h = h * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(c[2]);
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+
+    /**
+     * @brief Resolves a 1-based or negative (relative) OBJ index against the number of records read so far.
+     * @return The 0-based index, or -1 if it is out of range.
+     */
+    int resolve_obj_index(long index, size_t count)
+    {
+        long resolved = index > 0 ? index - 1 : static_cast<long>(count) + index;
+        return (index != 0 && resolved >= 0 && resolved < static_cast<long>(count)) ? static_cast<int>(resolved) : -1;
+    }
+
+    /**
+     * @brief Parses one face corner (v, v/vt, v//vn or v/vt/vn) starting at p, advancing p past it.
+     * @return False if the corner is malformed or refers to a missing record.
+     */
+    bool parse_obj_corner(const char *&p, size_t positions, size_t uvs, size_t normals, ObjCorner &corner)
+    {
+        char *end;
+        corner = {-1, -1, -1};
+
+        long v = std::strtol(p, &end, 10);
+        if (end == p)
+            return false;
+        corner[0] = resolve_obj_index(v, positions);
+        if (corner[0] < 0)
+            return false;
+        p = end;
+
+        if (*p == '/')
+        {
+            ++p;
+            if (*p != '/')
+            {
+                long vt = std::strtol(p, &end, 10);
+                if (end == p || (corner[1] = resolve_obj_index(vt, uvs)) < 0)
+                    return false;
+                p = end;
+            }
+            if (*p == '/')
+            {
+                ++p;
+                long vn = std::strtol(p, &end, 10);
+                if (end == p || (corner[2] = resolve_obj_index(vn, normals)) < 0)
+                    return false;
+                p = end;
+            }
+        }
+        return true;
+    }
+
+    /// Scalar types that may appear in a PLY header.
+    enum class PlyType
+    {
+        INT8,
+        UINT8,
+        INT16,
+        UINT16,
+        INT32,
+        UINT32,
+        FLOAT32,
+        FLOAT64,
+        INVALID
+    };
+
+    PlyType parse_ply_type(const std::string &name)
+    {
+        if (name == "char" || name == "int8")
+            return PlyType::INT8;
+        if (name == "uchar" || name == "uint8")
+            return PlyType::UINT8;
+        if (name == "short" || name == "int16")
+            return PlyType::INT16;
+        if (name == "ushort" || name == "uint16")
+            return PlyType::UINT16;
+        if (name == "int" || name == "int32")
+            return PlyType::INT32;
+        if (name == "uint" || name == "uint32")
+            return PlyType::UINT32;
+        if (name == "float" || name == "float32")
+            return PlyType::FLOAT32;
+        if (name == "double" || name == "float64")
+            return PlyType::FLOAT64;
+        return PlyType::INVALID;
+    }
+
+    size_t ply_type_size(PlyType type)
+    {
+        switch (type)
+        {
+        case PlyType::INT8:
+        case PlyType::UINT8:
+            return 1;
+        case PlyType::INT16:
+        case PlyType::UINT16:
+            return 2;
+        case PlyType::INT32:
+        case PlyType::UINT32:
+        case PlyType::FLOAT32:
+            return 4;
+        case PlyType::FLOAT64:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    struct PlyProperty
+    {
+        std::string name;
+        PlyType type = PlyType::INVALID;
+        PlyType count_type = PlyType::INVALID; ///< Type of the length prefix for list properties, INVALID otherwise.
+    };
+
+    struct PlyElement
+    {
+        std::string name;
+        size_t count = 0;
+        std::vector<PlyProperty> properties;
+    };
+
+    /**
+     * @brief Sequential reader over the binary body of a PLY file.
+     */
+    class PlyReader
+    {
+    public:
+        PlyReader(const std::vector<char> &data, bool big_endian) : data(data), big_endian(big_endian) {}
+
+        /**
+         * @brief Reads one scalar of the given type, converting it to double.
+         * @return False if the data ends before the value.
+         */
+        bool read(PlyType type, double &value)
+        {
+            size_t size = ply_type_size(type);
+            if (offset + size > data.size())
+                return false;
+
+            // Gather the value's bytes in host (little endian) order
+            unsigned char bytes[8];
+            for (size_t i = 0; i < size; ++i)
+                bytes[i] = static_cast<unsigned char>(data[offset + (big_endian ? size - 1 - i : i)]);
+            offset += size;
+
+            switch (type)
+            {
+            case PlyType::INT8: { int8_t x; std::memcpy(&x, bytes, 1); value = x; break; }
+            case PlyType::UINT8: { uint8_t x; std::memcpy(&x, bytes, 1); value = x; break; }
+            case PlyType::INT16: { int16_t x; std::memcpy(&x, bytes, 2); value = x; break; }
+            case PlyType::UINT16: { uint16_t x; std::memcpy(&x, bytes, 2); value = x; break; }
+            case PlyType::INT32: { int32_t x; std::memcpy(&x, bytes, 4); value = x; break; }
+            case PlyType::UINT32: { uint32_t x; std::memcpy(&x, bytes, 4); value = x; break; }
+            case PlyType::FLOAT32: { float x; std::memcpy(&x, bytes, 4); value = x; break; }
+            case PlyType::FLOAT64: { double x; std::memcpy(&x, bytes, 8); value = x; break; }
+            default: return false;
+            }
+            return true;
+        }
+
+    private:
+        const std::vector<char> &data;
+        bool big_endian;
+        size_t offset = 0;
+    };
+
+    /**
+     * @brief Checks that the mesh has faces and that every index refers to a vertex.
+     */
+    bool validate_mesh(const std::string &filename, const TriangleMesh &mesh)
+    {
+        if (mesh.owned_indices.empty())
+        {
+            std::cerr << "Error: Mesh file '" << filename << "' contains no faces." << std::endl;
+            return false;
+        }
+        for (uint32_t index : mesh.owned_indices)
+        {
+            if (index >= mesh.owned_positions.size())
+            {
+                std::cerr << "Error: Mesh file '" << filename << "' refers to missing vertex " << index << "." << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool MeshLoader::load(const std::string &filename, TriangleMesh &mesh)
+{
+    std::string extension = filename.substr(filename.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == "obj")
+        return load_obj(filename, mesh);
+    if (extension == "ply")
+        return load_ply(filename, mesh);
+
+    std::cerr << "Error: Unsupported mesh format '" << filename << "'. Expected .obj or .ply." << std::endl;
+    return false;
+}
+
+bool MeshLoader::load_obj(const std::string &filename, TriangleMesh &mesh)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        std::cerr << "Error: Cannot open mesh file: " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<Vec3> positions;
+    std::vector<float> uvs;
+    std::vector<Vec3> normals;
+    std::vector<ObjCorner> corners; // Three corners per triangle, after fan triangulation
+    std::vector<ObjCorner> polygon;
+
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        const char *p = line.c_str();
+        while (*p == ' ' || *p == '\t')
+            ++p;
+
+        char *end;
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            float x = std::strtof(p + 2, &end);
+            float y = std::strtof(end, &end);
+            float z = std::strtof(end, &end);
+            positions.emplace_back(x, y, z);
+        }
+        else if (p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t'))
+        {
+            float u = std::strtof(p + 3, &end);
+            float v = std::strtof(end, &end);
+            uvs.push_back(u);
+            uvs.push_back(v);
+        }
+        else if (p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t'))
+        {
+            float x = std::strtof(p + 3, &end);
+            float y = std::strtof(end, &end);
+            float z = std::strtof(end, &end);
+            normals.emplace_back(x, y, z);
+        }
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            polygon.clear();
+            p += 2;
+            while (true)
+            {
+                while (*p == ' ' || *p == '\t' || *p == '\r')
+                    ++p;
+                if (*p == '\0')
+                    break;
+
+                ObjCorner corner;
+                if (!parse_obj_corner(p, positions.size(), uvs.size() / 2, normals.size(), corner))
+                {
+                    std::cerr << "Error: Invalid face in '" << filename << "' at line " << line_number << "." << std::endl;
+                    return false;
+                }
+                polygon.push_back(corner);
+            }
+
+            // Triangulate the polygon as a fan around its first corner
+            for (size_t i = 2; i < polygon.size(); ++i)
+            {
+                corners.push_back(polygon[0]);
+                corners.push_back(polygon[i - 1]);
+                corners.push_back(polygon[i]);
+            }
+        }
+    }
+
+    bool has_uvs = !corners.empty();
+    bool has_normals = !corners.empty();
+    for (const ObjCorner &corner : corners)
+    {
+        has_uvs &= corner[1] >= 0;
+        has_normals &= corner[2] >= 0;
+    }
+
+    mesh.owned_positions.clear();
+    mesh.owned_normals.clear();
+    mesh.owned_uvs.clear();
+    mesh.owned_indices.clear();
+    mesh.owned_indices.reserve(corners.size());
+
+    if (!has_uvs && !has_normals)
+    {
+        // Positions alone: the OBJ indices can be used directly
+        mesh.owned_positions = std::move(positions);
+        for (const ObjCorner &corner : corners)
+            mesh.owned_indices.push_back(static_cast<uint32_t>(corner[0]));
+    }
+    else
+    {
+        // A mesh vertex is a distinct combination of position, texture coordinate and normal
+        std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> vertices;
+        vertices.reserve(positions.size());
+        for (const ObjCorner &corner : corners)
+        {
+            ObjCorner key = {corner[0], has_uvs ? corner[1] : -1, has_normals ? corner[2] : -1};
+            auto inserted = vertices.emplace(key, static_cast<uint32_t>(mesh.owned_positions.size()));
+            if (inserted.second)
+            {
+                mesh.owned_positions.push_back(positions[key[0]]);
+                if (has_uvs)
+                {
+                    mesh.owned_uvs.push_back(uvs[2 * key[1]]);
+                    mesh.owned_uvs.push_back(uvs[2 * key[1] + 1]);
+                }
+                if (has_normals)
+                    mesh.owned_normals.push_back(normals[key[2]]);
+            }
+            mesh.owned_indices.push_back(inserted.first->second);
+        }
+    }
+
+    mesh.owned_positions.shrink_to_fit();
+    mesh.owned_normals.shrink_to_fit();
+    mesh.owned_uvs.shrink_to_fit();
+    mesh.owned_indices.shrink_to_fit();
+    mesh.use_owned_buffers();
+    return validate_mesh(filename, mesh);
+}
+
+bool MeshLoader::load_ply(const std::string &filename, TriangleMesh &mesh)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Error: Cannot open mesh file: " << filename << std::endl;
+        return false;
+    }
+
+    // Read the header
+    std::string line;
+    std::getline(file, line);
+    if (line.compare(0, 3, "ply") != 0)
+    {
+        std::cerr << "Error: '" << filename << "' is not a PLY file." << std::endl;
+        return false;
+    }
+
+    bool big_endian = false;
+    std::vector<PlyElement> elements;
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+
+        if (keyword == "format")
+        {
+            std::string format;
+            tokens >> format;
+            if (format == "binary_big_endian")
+                big_endian = true;
+            else if (format != "binary_little_endian")
+            {
+                std::cerr << "Error: Unsupported PLY format '" << format << "' in '" << filename
+                          << "'. Only binary PLY files are supported." << std::endl;
+                return false;
+            }
+        }
+        else if (keyword == "element")
+        {
+            PlyElement element;
+            tokens >> element.name >> element.count;
+            elements.push_back(element);
+        }
+        else if (keyword == "property")
+        {
+            if (elements.empty())
+            {
+                std::cerr << "Error: PLY property before any element in '" << filename << "'." << std::endl;
+                return false;
+            }
+
+            PlyProperty property;
+            std::string type;
+            tokens >> type;
+            if (type == "list")
+            {
+                std::string count_type, item_type;
+                tokens >> count_type >> item_type;
+                property.count_type = parse_ply_type(count_type);
+                property.type = parse_ply_type(item_type);
+                if (property.count_type == PlyType::INVALID)
+                    property.type = PlyType::INVALID;
+            }
+            else
+            {
+                property.type = parse_ply_type(type);
+            }
+            tokens >> property.name;
+
+            if (property.type == PlyType::INVALID)
+            {
+                std::cerr << "Error: Unsupported PLY property type in '" << filename << "': " << line << std::endl;
+                return false;
+            }
+            elements.back().properties.push_back(property);
+        }
+        else if (keyword == "end_header")
+        {
+            break;
+        }
+    }
+
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    PlyReader reader(data, big_endian);
+
+    mesh.owned_positions.clear();
+    mesh.owned_normals.clear();
+    mesh.owned_uvs.clear();
+    mesh.owned_indices.clear();
+
+    for (const PlyElement &element : elements)
+    {
+        bool is_vertex = element.name == "vertex";
+        bool is_face = element.name == "face";
+
+        if (element.properties.size() > 16)
+        {
+            std::cerr << "Error: Too many properties on PLY element '" << element.name << "' in '" << filename << "'." << std::endl;
+            return false;
+        }
+
+        // Map vertex properties to attribute slots: position xyz, normal xyz, uv
+        int slot[16];
+        bool has_normals = false, has_uvs = false;
+        int list_property = -1;
+        for (size_t i = 0; i < element.properties.size(); ++i)
+        {
+            const std::string &name = element.properties[i].name;
+            slot[i] = -1;
+            if (is_vertex)
+            {
+                static const char *names[] = {"x", "y", "z", "nx", "ny", "nz", "u", "v", "s", "t"};
+                for (int k = 0; k < 10; ++k)
+                    if (name == names[k])
+                        slot[i] = k < 8 ? k : k - 2; // s, t are synonyms of u, v
+                has_normals |= slot[i] >= 3 && slot[i] <= 5;
+                has_uvs |= slot[i] >= 6;
+            }
+            else if (is_face && (name == "vertex_indices" || name == "vertex_index") &&
+                     element.properties[i].count_type != PlyType::INVALID)
+            {
+                list_property = static_cast<int>(i);
+            }
+        }
+        if (is_face && list_property < 0)
+        {
+            std::cerr << "Error: PLY face element has no vertex_indices list in '" << filename << "'." << std::endl;
+            return false;
+        }
+
+        if (is_vertex)
+        {
+            mesh.owned_positions.reserve(element.count);
+            if (has_normals)
+                mesh.owned_normals.reserve(element.count);
+            if (has_uvs)
+                mesh.owned_uvs.reserve(2 * element.count);
+        }
+        if (is_face)
+            mesh.owned_indices.reserve(3 * element.count);
+
+        std::vector<uint32_t> polygon;
+        for (size_t n = 0; n < element.count; ++n)
+        {
+            float attributes[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+            for (size_t i = 0; i < element.properties.size(); ++i)
+            {
+                const PlyProperty &property = element.properties[i];
+                double value;
+                if (property.count_type == PlyType::INVALID)
+                {
+                    if (!reader.read(property.type, value))
+                    {
+                        std::cerr << "Error: Unexpected end of PLY data in '" << filename << "'." << std::endl;
+                        return false;
+                    }
+                    if (slot[i] >= 0)
+                        attributes[slot[i]] = static_cast<float>(value);
+                    continue;
+                }
+
+                double count;
+                if (!reader.read(property.count_type, count))
+                {
+                    std::cerr << "Error: Unexpected end of PLY data in '" << filename << "'." << std::endl;
+                    return false;
+                }
+                polygon.clear();
+                for (size_t k = 0; k < static_cast<size_t>(count); ++k)
+                {
+                    if (!reader.read(property.type, value))
+                    {
+                        std::cerr << "Error: Unexpected end of PLY data in '" << filename << "'." << std::endl;
+                        return false;
+                    }
+                    polygon.push_back(static_cast<uint32_t>(value));
+                }
+
+                if (static_cast<int>(i) == list_property)
+                {
+                    // Triangulate the polygon as a fan around its first vertex
+                    for (size_t k = 2; k < polygon.size(); ++k)
+                    {
+                        mesh.owned_indices.push_back(polygon[0]);
+                        mesh.owned_indices.push_back(polygon[k - 1]);
+                        mesh.owned_indices.push_back(polygon[k]);
+                    }
+                }
+            }
+
+            if (is_vertex)
+            {
+                mesh.owned_positions.emplace_back(attributes[0], attributes[1], attributes[2]);
+                if (has_normals)
+                    mesh.owned_normals.emplace_back(attributes[3], attributes[4], attributes[5]);
+                if (has_uvs)
+                {
+                    mesh.owned_uvs.push_back(attributes[6]);
+                    mesh.owned_uvs.push_back(attributes[7]);
+                }
+            }
+        }
+    }
+
+    mesh.owned_indices.shrink_to_fit();
+    mesh.use_owned_buffers();
+    return validate_mesh(filename, mesh);
+}
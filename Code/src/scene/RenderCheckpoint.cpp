@@ -0,0 +1,153 @@
+#include "scene/RenderCheckpoint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+constexpr char RenderCheckpoint::kMagic[8];
+constexpr uint32_t RenderCheckpoint::kVersion;
+
+namespace
+{
+    /// Top-level description keys that cannot change the value of a sample.
+    const char *const kSampleIndependentKeys[] = {
+        "nsamples", "progressive", "progressive_pass_samples", "checkpoint", "checkpoint_interval",
+        "time_budget_ms", "scheduler", "tile_size", "use_bvh", "bvh_builder", "bvh_width", "use_bvh_cache",
+        "bvh_cache_dir", "bvh_cache_max_mb", "use_denoiser", "bilateral_sigma_spatial", "bilateral_sigma_range",
+        "use_tone_mapping", "use_gaussian_blur", "blur_sigma", "blur_kernel_size", "importance_sampling_heatmap"};
+}
+
+uint64_t RenderCheckpoint::description_key(const nlohmann::json &description)
+{
+    nlohmann::json relevant = description;
+    if (relevant.is_object())
+    {
+        for (const char *key : kSampleIndependentKeys)
+            relevant.erase(key);
+    }
+
+    // FNV-1a over the canonical dump: object keys are sorted and floats round-trip exactly
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : relevant.dump())
+    {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+RenderCheckpoint::RenderCheckpoint(const SceneConfig &config, uint64_t bounds_key)
+{
+    const size_t pixels = static_cast<size_t>(config.image_width) * config.image_height;
+    sums.assign(pixels, Vec3(0, 0, 0));
+    counts.assign(pixels, 0);
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.width = static_cast<uint32_t>(config.image_width);
+    header.height = static_cast<uint32_t>(config.image_height);
+    header.seed = config.seed;
+    header.sampler = static_cast<uint32_t>(config.sampler);
+    header.max_ray_depth = static_cast<uint32_t>(config.max_ray_depth);
+    header.stratified_samples = config.use_stratified_sampling ? static_cast<uint32_t>(config.sqrt_samples) : 0;
+    header.description_key = config.description_key;
+    header.bounds_key = bounds_key;
+}
+
+bool RenderCheckpoint::load(const std::string &path, uint32_t max_samples)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+
+    CheckpointHeader stored;
+    if (!in.read(reinterpret_cast<char *>(&stored), sizeof(stored)) ||
+        std::memcmp(stored.magic, kMagic, sizeof(kMagic)) != 0 || stored.version != kVersion)
+    {
+        std::cerr << "Warning: '" << path << "' is not a checkpoint of this version. Starting from zero." << std::endl;
+        return false;
+    }
+    if (std::memcmp(&stored, &header, sizeof(header)) != 0)
+    {
+        std::cerr << "Warning: Checkpoint '" << path << "' belongs to a different scene or settings. "
+                  << "Starting from zero." << std::endl;
+        return false;
+    }
+
+    std::vector<float> values(3 * sums.size());
+    std::vector<uint32_t> stored_counts(counts.size());
+    in.read(reinterpret_cast<char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(float)));
+    in.read(reinterpret_cast<char *>(stored_counts.data()),
+            static_cast<std::streamsize>(stored_counts.size() * sizeof(uint32_t)));
+    if (!in || in.peek() != std::ifstream::traits_type::eof())
+    {
+        std::cerr << "Warning: Checkpoint '" << path << "' is truncated or corrupt. Starting from zero." << std::endl;
+        return false;
+    }
+
+    if (!stored_counts.empty() && *std::max_element(stored_counts.begin(), stored_counts.end()) > max_samples)
+    {
+        std::cerr << "Warning: Checkpoint '" << path << "' holds more than the " << max_samples
+                  << " samples per pixel requested. Starting from zero." << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < sums.size(); ++i)
+    {
+        sums[i] = Vec3(values[3 * i], values[3 * i + 1], values[3 * i + 2]);
+    }
+    counts = std::move(stored_counts);
+    return true;
+}
+
+bool RenderCheckpoint::save(const std::string &path) const
+{
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "Warning: Cannot write checkpoint '" << temporary << "'." << std::endl;
+            return false;
+        }
+
+        std::vector<float> values(3 * sums.size());
+        for (size_t i = 0; i < sums.size(); ++i)
+        {
+            values[3 * i] = sums[i].x;
+            values[3 * i + 1] = sums[i].y;
+            values[3 * i + 2] = sums[i].z;
+        }
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(float)));
+        out.write(reinterpret_cast<const char *>(counts.data()),
+                  static_cast<std::streamsize>(counts.size() * sizeof(uint32_t)));
+        if (!out.flush())
+        {
+            std::cerr << "Warning: Cannot write checkpoint '" << temporary << "'." << std::endl;
+            return false;
+        }
+    }
+
+    // Renaming replaces the previous checkpoint in one step
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+    {
+        std::cerr << "Warning: Cannot store checkpoint '" << path << "': " << error.message() << std::endl;
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+uint32_t RenderCheckpoint::min_samples() const
+{
+    return counts.empty() ? 0 : *std::min_element(counts.begin(), counts.end());
+}
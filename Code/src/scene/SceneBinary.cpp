@@ -0,0 +1,566 @@
+#include "scene/SceneBinary.h"
+#include "scene/MeshLoader.h"
+#include "scene/SceneLoader.h"
+#include "geometry/LinearBVH.h"
+#include "geometry/WideBVH.h"
+#include "geometry/SplitHierarchy.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+    /// Deepest hierarchy the BVH traversal stacks can hold.
+    constexpr size_t kMaxBVHDepth = LinearBVH::kMaxDepth;
+
+    /**
+     * @brief Pads a file stream with zeros up to the next section boundary and returns the new offset.
+     */
+    uint64_t align_stream(std::ostream &out)
+    {
+        static const char zeros[SceneBinary::kSectionAlignment] = {};
+        uint64_t offset = static_cast<uint64_t>(out.tellp());
+        uint64_t padding = (SceneBinary::kSectionAlignment - offset % SceneBinary::kSectionAlignment) % SceneBinary::kSectionAlignment;
+        out.write(zeros, static_cast<std::streamsize>(padding));
+        return offset + padding;
+    }
+
+    /**
+     * @brief Writes a section at the next boundary and returns its offset, or 0 for an empty section.
+     */
+    uint64_t write_section(std::ostream &out, const void *data, size_t size)
+    {
+        if (size == 0)
+            return 0;
+        uint64_t offset = align_stream(out);
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        return offset;
+    }
+
+    /**
+     * @brief Finds the position of every leaf slot's object in the original object list.
+     */
+    std::vector<uint32_t> primitive_order(const std::vector<std::shared_ptr<Hittable>> &ordered,
+                                          const std::vector<std::shared_ptr<Hittable>> &objects)
+    {
+        std::unordered_map<const Hittable *, uint32_t> index_of;
+        index_of.reserve(objects.size());
+        for (size_t i = 0; i < objects.size(); ++i)
+            index_of.emplace(objects[i].get(), static_cast<uint32_t>(i));
+
+        std::vector<uint32_t> order(ordered.size());
+        for (size_t i = 0; i < ordered.size(); ++i)
+            order[i] = index_of.at(ordered[i].get());
+        return order;
+    }
+
+    /**
+     * @brief Checks a binary BVH's links and leaf ranges, and that it fits the traversal stack.
+     *        Nodes are in depth-first order, so every child lies after its parent and links cannot form cycles.
+     *        Every node but the root has exactly one parent, so the depth recorded for it is the depth at which
+     *        traversal reaches it; a node shared by two parents could be checked at the shallower one's depth.
+     */
+    bool validate_nodes(const LinearBVHNode *nodes, size_t node_count, size_t object_count)
+    {
+        std::vector<uint8_t> depth(node_count, 0);
+        for (size_t i = 0; i < node_count; ++i)
+        {
+            const LinearBVHNode &node = nodes[i];
+            if (depth[i] >= kMaxBVHDepth)
+                return false;
+            if (node.n_primitives > 0)
+            {
+                if (node.primitives_offset < 0 || static_cast<size_t>(node.primitives_offset) + node.n_primitives > object_count)
+                    return false;
+                continue;
+            }
+            size_t second = static_cast<size_t>(node.second_child_offset);
+            if (node.axis > 2 || i + 1 >= node_count || node.second_child_offset <= static_cast<int32_t>(i + 1) || second >= node_count)
+                return false;
+            // Only the root has depth 0, so a nonzero depth means the child already has a parent
+            if (depth[i + 1] != 0 || depth[second] != 0)
+                return false;
+            depth[i + 1] = depth[second] = static_cast<uint8_t>(depth[i] + 1);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks a wide BVH's links and leaf ranges, and that it fits the traversal stack. As for the binary
+     *        layout, children lie after their parent and every node but the root has exactly one parent.
+     */
+    template <int Width>
+    bool validate_nodes(const WideBVHNode<Width> *nodes, size_t node_count, size_t object_count)
+    {
+        std::vector<uint8_t> depth(node_count, 0);
+        for (size_t i = 0; i < node_count; ++i)
+        {
+            if (depth[i] >= kMaxBVHDepth)
+                return false;
+            for (int c = 0; c < Width; ++c)
+            {
+                int32_t child = nodes[i].children[c];
+                if (child < 0)
+                {
+                    // Traversal relies on an empty slot's inverted box never being hit
+                    for (int a = 0; a < 3; ++a)
+                        if (!(nodes[i].bounds[a][c] == std::numeric_limits<float>::infinity() &&
+                              nodes[i].bounds[a + 3][c] == -std::numeric_limits<float>::infinity()))
+                            return false;
+                    if (nodes[i].counts[c] != 0)
+                        return false;
+                    continue;
+                }
+                if (nodes[i].counts[c] > 0)
+                {
+                    if (static_cast<size_t>(child) + nodes[i].counts[c] > object_count)
+                        return false;
+                }
+                else
+                {
+                    if (static_cast<size_t>(child) <= i || static_cast<size_t>(child) >= node_count ||
+                        depth[child] != 0)
+                        return false;
+                    depth[child] = static_cast<uint8_t>(depth[i] + 1);
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Appends the arrays of a BVH and returns the offset of its record.
+     */
+    template <typename Node>
+    uint64_t write_bvh_arrays(std::ostream &out, RtbinBVH record, const Node *nodes,
+                              const std::vector<uint32_t> &order)
+    {
+        record.node_size = sizeof(Node);
+        record.nodes_offset = write_section(out, nodes, record.node_count * sizeof(Node));
+        record.primitive_order_offset = write_section(out, order.data(), order.size() * sizeof(uint32_t));
+        return write_section(out, &record, sizeof(record));
+    }
+
+    /**
+     * @brief Stores the final header at the start of an assembled file and writes it to disk.
+     */
+    bool write_image(std::stringstream &image, RtbinHeader &header, const std::string &path)
+    {
+        image.seekp(0, std::ios::end);
+        header.file_size = static_cast<uint64_t>(image.tellp());
+        image.seekp(0);
+        image.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        image.seekg(0);
+        out << image.rdbuf();
+        out.close();
+        if (!out)
+        {
+            std::cerr << "Error: Failed writing scene file: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns whether a material description uses an image texture, whose coordinates differ between
+     *        Triangle and MeshTriangle.
+     */
+    bool is_textured(const nlohmann::json &material_json)
+    {
+        return material_json.contains("texture");
+    }
+}
+
+constexpr char SceneBinary::kMagic[8];
+
+std::shared_ptr<SceneBinary> SceneBinary::open(const std::string &filename)
+{
+    auto file = MappedFile::open(filename);
+    if (!file)
+    {
+        std::cerr << "Error: Cannot open scene file: " << filename << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<SceneBinary> binary(new SceneBinary());
+    binary->file = file;
+    if (file->size() < sizeof(RtbinHeader))
+    {
+        std::cerr << "Error: '" << filename << "' is too small to be a .rtbin file." << std::endl;
+        return nullptr;
+    }
+
+    const RtbinHeader *header = reinterpret_cast<const RtbinHeader *>(file->data());
+    binary->header = header;
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0)
+    {
+        std::cerr << "Error: '" << filename << "' is not a .rtbin file." << std::endl;
+        return nullptr;
+    }
+    if (header->version != kVersion || header->byte_order != kByteOrderMark)
+    {
+        std::cerr << "Error: '" << filename << "' has version " << header->version
+                  << " or byte order unsupported by this build; convert the scene again." << std::endl;
+        return nullptr;
+    }
+    if (header->file_size != file->size() ||
+        !binary->in_bounds(header->description_offset, header->description_size, 1) ||
+        header->mesh_count > file->size() / sizeof(RtbinMesh) ||
+        !binary->in_bounds(header->meshes_offset, header->mesh_count * sizeof(RtbinMesh), alignof(RtbinMesh)))
+    {
+        std::cerr << "Error: '" << filename << "' is truncated or corrupt." << std::endl;
+        return nullptr;
+    }
+
+    const RtbinMesh *records = reinterpret_cast<const RtbinMesh *>(file->data() + header->meshes_offset);
+    for (uint64_t i = 0; i < header->mesh_count; ++i)
+    {
+        const RtbinMesh &mesh = records[i];
+        uint64_t vertex_bytes = uint64_t(mesh.vertex_count) * sizeof(Vec3);
+        bool valid = mesh.face_count > 0 &&
+                     binary->in_bounds(mesh.positions_offset, vertex_bytes, alignof(Vec3)) &&
+                     binary->in_bounds(mesh.indices_offset, uint64_t(mesh.face_count) * 3 * sizeof(uint32_t), alignof(uint32_t)) &&
+                     (mesh.normals_offset == 0 || binary->in_bounds(mesh.normals_offset, vertex_bytes, alignof(Vec3))) &&
+                     (mesh.uvs_offset == 0 || binary->in_bounds(mesh.uvs_offset, uint64_t(mesh.vertex_count) * 2 * sizeof(float), alignof(float)));
+        if (valid)
+        {
+            // Indices are checked once here so that intersection never reads outside the vertex buffers
+            const uint32_t *indices = reinterpret_cast<const uint32_t *>(file->data() + mesh.indices_offset);
+            for (uint64_t k = 0; k < uint64_t(mesh.face_count) * 3 && valid; ++k)
+                valid = indices[k] < mesh.vertex_count;
+        }
+        if (!valid)
+        {
+            std::cerr << "Error: Mesh " << i << " in '" << filename << "' is corrupt." << std::endl;
+            return nullptr;
+        }
+        binary->meshes.push_back(mesh);
+    }
+
+    if (header->bvh_offset != 0)
+    {
+        if (!binary->in_bounds(header->bvh_offset, sizeof(RtbinBVH), alignof(RtbinBVH)))
+        {
+            std::cerr << "Error: The BVH record in '" << filename << "' is corrupt." << std::endl;
+            return nullptr;
+        }
+        binary->bvh = reinterpret_cast<const RtbinBVH *>(file->data() + header->bvh_offset);
+    }
+
+    return binary;
+}
+
+bool SceneBinary::in_bounds(uint64_t offset, uint64_t size, uint64_t alignment) const
+{
+    return offset % alignment == 0 && offset <= file->size() && size <= file->size() - offset;
+}
+
+std::string SceneBinary::description() const
+{
+    return std::string(file->data() + header->description_offset, header->description_size);
+}
+
+void SceneBinary::attach_mesh(size_t index, TriangleMesh &mesh) const
+{
+    const RtbinMesh &record = meshes[index];
+    const char *base = file->data();
+    mesh.positions = reinterpret_cast<const Vec3 *>(base + record.positions_offset);
+    mesh.normals = record.normals_offset ? reinterpret_cast<const Vec3 *>(base + record.normals_offset) : nullptr;
+    mesh.uvs = record.uvs_offset ? reinterpret_cast<const float *>(base + record.uvs_offset) : nullptr;
+    mesh.indices = reinterpret_cast<const uint32_t *>(base + record.indices_offset);
+    mesh.vertex_count = record.vertex_count;
+    mesh.faces = record.face_count;
+    mesh.mapped_storage = file;
+}
+
+std::shared_ptr<Hittable> SceneBinary::adopt_bvh(const std::vector<std::shared_ptr<Hittable>> &objects,
+                                                 const SceneConfig &config) const
+{
+    if (!bvh)
+        return nullptr;
+    if (bvh->width != static_cast<uint32_t>(config.bvh_width) ||
+        bvh->builder != static_cast<uint32_t>(config.bvh_builder) ||
+        bvh->object_count != objects.size() || bvh->node_count == 0)
+        return nullptr;
+
+    size_t node_size = bvh->width == 8 ? sizeof(WideBVHNode<8>) : bvh->width == 4 ? sizeof(WideBVHNode<4>) : sizeof(LinearBVHNode);
+    if (bvh->node_size != node_size || bvh->node_count > file->size() / node_size ||
+        !in_bounds(bvh->nodes_offset, bvh->node_count * node_size, 32) ||
+        !in_bounds(bvh->primitive_order_offset, bvh->object_count * sizeof(uint32_t), alignof(uint32_t)))
+        return nullptr;
+
+    const char *base = file->data();
+    const uint32_t *order = reinterpret_cast<const uint32_t *>(base + bvh->primitive_order_offset);
+    for (uint64_t i = 0; i < bvh->object_count; ++i)
+        if (order[i] >= objects.size())
+            return nullptr;
+
+    if (bvh->width == 8)
+    {
+        auto nodes = reinterpret_cast<const WideBVHNode<8> *>(base + bvh->nodes_offset);
+        if (!validate_nodes(nodes, bvh->node_count, objects.size()))
+            return nullptr;
+        return std::make_shared<BVH8>(objects, nodes, bvh->node_count, order, bvh->sah_cost, file);
+    }
+    if (bvh->width == 4)
+    {
+        auto nodes = reinterpret_cast<const WideBVHNode<4> *>(base + bvh->nodes_offset);
+        if (!validate_nodes(nodes, bvh->node_count, objects.size()))
+            return nullptr;
+        return std::make_shared<BVH4>(objects, nodes, bvh->node_count, order, bvh->sah_cost, file);
+    }
+    auto nodes = reinterpret_cast<const LinearBVHNode *>(base + bvh->nodes_offset);
+    if (!validate_nodes(nodes, bvh->node_count, objects.size()))
+        return nullptr;
+    return std::make_shared<LinearBVH>(objects, nodes, bvh->node_count, order, file);
+}
+
+uint64_t SceneBinary::write_bvh(std::ostream &out, const Hittable &root,
+                                const std::vector<std::shared_ptr<Hittable>> &objects, const SceneConfig &config)
+{
+    // Unbounded objects are kept out of the BVH, which is stored over the bounded objects alone
+    if (auto split = dynamic_cast<const SplitHierarchy *>(&root))
+    {
+        if (!split->bounded_hierarchy())
+            return 0;
+        std::vector<std::shared_ptr<Hittable>> bounded, unbounded;
+        SplitHierarchy::partition(objects, bounded, unbounded);
+        return write_bvh(out, *split->bounded_hierarchy(), bounded, config);
+    }
+
+    RtbinBVH record = {};
+    record.width = static_cast<uint32_t>(config.bvh_width);
+    record.builder = static_cast<uint32_t>(config.bvh_builder);
+    record.object_count = objects.size();
+
+    if (auto bvh8 = dynamic_cast<const BVH8 *>(&root))
+    {
+        record.node_count = bvh8->node_count();
+        record.sah_cost = bvh8->sah_cost();
+        return write_bvh_arrays(out, record, bvh8->flattened_nodes(), primitive_order(bvh8->ordered_primitives(), objects));
+    }
+    if (auto bvh4 = dynamic_cast<const BVH4 *>(&root))
+    {
+        record.node_count = bvh4->node_count();
+        record.sah_cost = bvh4->sah_cost();
+        return write_bvh_arrays(out, record, bvh4->flattened_nodes(), primitive_order(bvh4->ordered_primitives(), objects));
+    }
+    if (auto bvh2 = dynamic_cast<const LinearBVH *>(&root))
+    {
+        record.width = 2;
+        record.node_count = bvh2->node_count();
+        record.sah_cost = bvh2->sah_cost();
+        return write_bvh_arrays(out, record, bvh2->flattened_nodes(), primitive_order(bvh2->ordered_primitives(), objects));
+    }
+    return 0;
+}
+
+uint64_t SceneBinary::write_bvh_file(const std::string &path, const std::string &description, const Hittable &root,
+                                     const std::vector<std::shared_ptr<Hittable>> &objects, const SceneConfig &config)
+{
+    // Unlike convert, nothing is read back before the header is final, so the file is written directly
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        std::cerr << "Error: Cannot create scene file: " << path << std::endl;
+        return 0;
+    }
+
+    RtbinHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    header.description_offset = write_section(out, description.data(), description.size());
+    header.description_size = description.size();
+    header.meshes_offset = align_stream(out);
+    header.bvh_offset = write_bvh(out, root, objects, config);
+    if (header.bvh_offset == 0)
+        return 0;
+    header.file_size = align_stream(out);
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+    if (!out)
+    {
+        std::cerr << "Error: Failed writing scene file: " << path << std::endl;
+        return 0;
+    }
+    return header.file_size;
+}
+
+bool SceneBinary::convert(const std::string &json_path, const std::string &rtbin_path, bool with_bvh)
+{
+    std::ifstream input(json_path);
+    if (!input.is_open())
+    {
+        std::cerr << "Error: Cannot open JSON file: " << json_path << std::endl;
+        return false;
+    }
+    nlohmann::json json = nlohmann::json::parse(input, nullptr, false);
+    input.close();
+    if (json.is_discarded())
+    {
+        std::cerr << "Error: '" << json_path << "' is not valid JSON." << std::endl;
+        return false;
+    }
+
+    // Gather the meshes: referenced files, and runs of triangles sharing a material
+    std::vector<std::unique_ptr<TriangleMesh>> meshes;
+    size_t merged_triangles = 0;
+    auto convert_shapes = [&](const nlohmann::json &shapes_json, nlohmann::json &shapes) -> bool
+    {
+        for (const auto &shape_json : shapes_json)
+        {
+            std::string type = shape_json.value("type", "");
+            if (type == "mesh" && shape_json.contains("file"))
+            {
+                auto mesh = std::make_unique<TriangleMesh>();
+                if (!MeshLoader::load(shape_json["file"].get<std::string>(), *mesh))
+                    return false;
+
+                nlohmann::json converted = shape_json;
+                converted.erase("file");
+                converted["buffer"] = meshes.size();
+                shapes.push_back(converted);
+                meshes.push_back(std::move(mesh));
+                continue;
+            }
+
+            bool mergeable = type == "triangle" && shape_json.contains("v0") && shape_json.contains("v1") &&
+                             shape_json.contains("v2") && shape_json.contains("material") &&
+                             !is_textured(shape_json["material"]);
+            if (!mergeable)
+            {
+                shapes.push_back(shape_json);
+                continue;
+            }
+
+            // Extend the previous shape if it is a triangle run with the same material
+            if (shapes.empty() || !shapes.back().contains("merged") ||
+                shapes.back()["material"] != shape_json["material"])
+            {
+                nlohmann::json converted = {{"type", "mesh"}, {"buffer", meshes.size()}, {"merged", true},
+                                            {"material", shape_json["material"]}};
+                if (shape_json.contains("_comment"))
+                    converted["_comment"] = shape_json["_comment"];
+                shapes.push_back(converted);
+                meshes.push_back(std::make_unique<TriangleMesh>());
+            }
+
+            TriangleMesh &mesh = *meshes.back();
+            for (const char *key : {"v0", "v1", "v2"})
+            {
+                const auto &v = shape_json[key];
+                mesh.owned_indices.push_back(static_cast<uint32_t>(mesh.owned_positions.size()));
+                mesh.owned_positions.emplace_back(v[0].get<float>(), v[1].get<float>(), v[2].get<float>());
+            }
+            ++merged_triangles;
+        }
+
+        for (auto &shape_json : shapes)
+            shape_json.erase("merged");
+        return true;
+    };
+
+    if (json.contains("scene"))
+    {
+        nlohmann::json &scene_json = json["scene"];
+        if (scene_json.contains("prototypes"))
+        {
+            for (auto &entry : scene_json["prototypes"].items())
+            {
+                if (!entry.value().contains("shapes"))
+                    continue;
+                nlohmann::json shapes = nlohmann::json::array();
+                if (!convert_shapes(entry.value()["shapes"], shapes))
+                    return false;
+                entry.value()["shapes"] = shapes;
+            }
+        }
+        if (scene_json.contains("shapes"))
+        {
+            nlohmann::json shapes = nlohmann::json::array();
+            if (!convert_shapes(scene_json["shapes"], shapes))
+                return false;
+            scene_json["shapes"] = shapes;
+        }
+        for (auto &mesh : meshes)
+            if (!mesh->positions)
+                mesh->use_owned_buffers();
+    }
+
+    // The file is assembled in memory so it can be rewritten once the BVH has been built from it
+    std::stringstream image(std::ios::in | std::ios::out | std::ios::binary);
+
+    RtbinHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    image.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::string description = json.dump();
+    header.description_offset = write_section(image, description.data(), description.size());
+    header.description_size = description.size();
+
+    std::vector<RtbinMesh> records;
+    for (const auto &mesh : meshes)
+    {
+        RtbinMesh record = {};
+        record.vertex_count = mesh->vertex_count;
+        record.face_count = mesh->faces;
+        record.positions_offset = write_section(image, mesh->positions, mesh->vertex_count * sizeof(Vec3));
+        if (mesh->normals)
+            record.normals_offset = write_section(image, mesh->normals, mesh->vertex_count * sizeof(Vec3));
+        if (mesh->uvs)
+            record.uvs_offset = write_section(image, mesh->uvs, mesh->vertex_count * 2 * sizeof(float));
+        record.indices_offset = write_section(image, mesh->indices, size_t(mesh->faces) * 3 * sizeof(uint32_t));
+        records.push_back(record);
+    }
+    meshes.clear();
+    header.mesh_count = records.size();
+    header.meshes_offset = records.empty() ? align_stream(image)
+                                           : write_section(image, records.data(), records.size() * sizeof(RtbinMesh));
+    align_stream(image);
+
+    if (!write_image(image, header, rtbin_path))
+        return false;
+    std::cout << "Wrote " << rtbin_path << ": " << records.size() << " meshes ("
+              << merged_triangles << " triangle shapes merged), " << header.file_size << " bytes" << std::endl;
+    if (!with_bvh)
+        return true;
+
+    // Build the hierarchy exactly as a render of the new file would, then append it
+    uint64_t bvh_offset = 0;
+    int bvh_width = 0;
+    {
+        Scene scene;
+        SceneConfig config;
+        SceneLoader loader;
+        loader.load_scene_from_file(scene, config, rtbin_path);
+        if (!config.use_bvh || !scene.scene_root)
+            return true;
+
+        image.seekp(0, std::ios::end);
+        bvh_offset = write_bvh(image, *scene.scene_root, scene.objects, config);
+        align_stream(image);
+        bvh_width = config.bvh_width;
+    }
+
+    // The scene, and with it the mapping of the file, has been released before the file is rewritten
+    header.bvh_offset = bvh_offset;
+    if (!write_image(image, header, rtbin_path))
+        return false;
+    std::cout << "Appended BVH" << bvh_width << ": " << header.file_size << " bytes" << std::endl;
+    return true;
+}
@@ -11,6 +11,15 @@
 #include "geometry/Triangle.h"
 #include "geometry/Rectangle.h"
 #include "geometry/Box.h"
+#include "geometry/Instance.h"
+#include "geometry/Plane.h"
+#include "geometry/SplitHierarchy.h"
+#include "scene/MeshLoader.h"
+#include "scene/SceneBinary.h"
+#include "scene/BVHCache.h"
+#include "scene/RenderCheckpoint.h"
+
+#include <chrono>
 
 void SceneLoader::load_default_scene(Scene &scene, SceneConfig &config)
 {
@@ -31,12 +40,49 @@ void SceneLoader::load_default_scene(Scene &scene, SceneConfig &config)
     build_scene(scene, config);
 }
 
+void SceneLoader::load_scene_from_file(Scene &scene, SceneConfig &config, const std::string &path)
+{
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    if (extension == "rtbin")
+    {
+        load_scene_from_binary(scene, config, path);
+    }
+    else
+    {
+        load_scene_from_json(scene, config, path);
+    }
+}
+
 void SceneLoader::load_scene_from_json(Scene &scene, SceneConfig &config, const std::string &json_path)
 {
     setup_custom_scene(scene, config, json_path);
     build_scene(scene, config);
 }
 
+void SceneLoader::load_scene_from_binary(Scene &scene, SceneConfig &config, const std::string &rtbin_path)
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+    binary = SceneBinary::open(rtbin_path);
+    if (!binary)
+        return;
+
+    nlohmann::json json = nlohmann::json::parse(binary->description(), nullptr, false);
+    if (json.is_discarded())
+    {
+        std::cerr << "Error: The scene description in '" << rtbin_path << "' is corrupt." << std::endl;
+        binary.reset();
+        return;
+    }
+    parse_json(scene, config, json);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Mapped scene '" << rtbin_path << "': " << binary->mesh_count() << " meshes, "
+              << scene.objects.size() << " objects in "
+              << std::chrono::duration<double, std::milli>(end_time - start_time).count() << " ms" << std::endl;
+
+    build_scene(scene, config);
+    binary.reset();
+}
+
 void SceneLoader::build_scene(Scene &scene, SceneConfig &config)
 {
     if (config.use_stratified_sampling)
@@ -45,29 +91,121 @@ void SceneLoader::build_scene(Scene &scene, SceneConfig &config)
         config.inv_sqrt_samples = 1.0f / config.sqrt_samples;
         config.sqrt_samples_squared = float(config.sqrt_samples * config.sqrt_samples);
     }
-    if (config.use_bvh)
+    if (config.use_bvh && binary)
     {
-        scene.scene_root = std::make_shared<BVHNode>(scene.objects, 0, scene.objects.size());
+        // A hierarchy stored with the scene is used in place when it was built with the same settings
+        auto adopt_start = std::chrono::high_resolution_clock::now();
+        std::vector<std::shared_ptr<Hittable>> bounded, unbounded;
+        SplitHierarchy::partition(scene.objects, bounded, unbounded);
+        std::shared_ptr<Hittable> bvh = bounded.empty() ? nullptr : binary->adopt_bvh(bounded, config);
+        if (bvh)
+        {
+            auto adopt_time = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - adopt_start);
+            std::cout << "BVH" << config.bvh_width << " loaded from scene file over " << bounded.size()
+                      << " objects, " << adopt_time.count() / 1000.0f << " ms" << std::endl;
+            scene.scene_root = unbounded.empty() ? bvh : std::make_shared<SplitHierarchy>(bvh, unbounded);
+            return;
+        }
     }
-    else
+    scene.scene_root = build_hierarchy(scene.objects, config);
+}
+
+std::shared_ptr<Hittable> SceneLoader::build_hierarchy(const std::vector<std::shared_ptr<Hittable>> &objects,
+                                                       const SceneConfig &config)
+{
+    if (!config.use_bvh)
     {
         auto list = std::make_shared<HittableList>();
-        for (const auto &object : scene.objects)
+        for (const auto &object : objects)
         {
             list->add(object);
         }
-        scene.scene_root = list;
+        return list;
+    }
+
+    // Unbounded objects would give the BVH a root box around everything, so they are tested alongside it instead
+    std::vector<std::shared_ptr<Hittable>> bounded, unbounded;
+    SplitHierarchy::partition(objects, bounded, unbounded);
+    if (!unbounded.empty())
+    {
+        std::cout << "Keeping " << unbounded.size() << " unbounded objects out of the BVH" << std::endl;
+        std::shared_ptr<Hittable> bvh = bounded.empty() ? nullptr : build_hierarchy(bounded, config);
+        return std::make_shared<SplitHierarchy>(bvh, unbounded);
     }
+
+    // Static scenes re-rendered with other cameras or sample counts map the hierarchy built by an earlier run
+    bool use_cache = config.use_bvh_cache && objects.size() >= BVHCache::kMinObjects;
+    uint64_t cache_key = 0;
+    if (use_cache)
+    {
+        auto cache_start = std::chrono::high_resolution_clock::now();
+        cache_key = BVHCache::geometry_key(objects, config);
+        std::shared_ptr<Hittable> cached = BVHCache::load(cache_key, objects, config);
+        auto cache_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - cache_start);
+        if (cached)
+        {
+            std::cout << "BVH cache hit: BVH" << config.bvh_width << " over " << objects.size()
+                      << " objects loaded from " << BVHCache::entry_path(cache_key, config) << ", "
+                      << cache_time.count() / 1000.0f << " ms" << std::endl;
+            return cached;
+        }
+        std::cout << "BVH cache miss: " << BVHCache::entry_path(cache_key, config) << std::endl;
+    }
+
+    auto build_start = std::chrono::high_resolution_clock::now();
+    std::shared_ptr<Hittable> root;
+    size_t node_count = 0;
+    float sah_cost = 0.0f;
+    if (config.bvh_width == 8)
+    {
+        auto bvh = std::make_shared<BVH8>(objects, config.bvh_builder);
+        node_count = bvh->node_count();
+        sah_cost = bvh->sah_cost();
+        root = bvh;
+    }
+    else if (config.bvh_width == 4)
+    {
+        auto bvh = std::make_shared<BVH4>(objects, config.bvh_builder);
+        node_count = bvh->node_count();
+        sah_cost = bvh->sah_cost();
+        root = bvh;
+    }
+    else
+    {
+        auto bvh = std::make_shared<LinearBVH>(objects, config.bvh_builder);
+        node_count = bvh->node_count();
+        sah_cost = bvh->sah_cost();
+        root = bvh;
+    }
+    auto build_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - build_start);
+
+    static const char *builder_names[] = {"median", "sah", "lbvh", "hlbvh"};
+    std::cout << "BVH" << config.bvh_width << " (" << builder_names[static_cast<int>(config.bvh_builder)]
+              << ") built over " << objects.size() << " objects: "
+              << node_count << " nodes, SAH cost " << sah_cost << ", "
+              << build_time.count() / 1000.0f << " ms" << std::endl;
+
+    if (use_cache)
+    {
+        uint64_t entry_size = BVHCache::store(cache_key, *root, objects, config);
+        if (entry_size > 0)
+            std::cout << "BVH cache stored: " << BVHCache::entry_path(cache_key, config) << ", "
+                      << entry_size << " bytes" << std::endl;
+    }
+    return root;
 }
 
 void SceneLoader::setup_default_scene(Scene &scene, [[maybe_unused]] SceneConfig &config)
 {
     // Materials with more variety
-    auto ground_diffuse = std::make_shared<Diffuse>(Vec3(0.2, 0.2, 0.2));
-    auto red_metal = std::make_shared<Metal>(Vec3(0.8, 0.2, 0.2), 0.1);
-    auto blue_metal = std::make_shared<Metal>(Vec3(0.2, 0.2, 0.8), 0.3);
-    auto glass_sphere = std::make_shared<Dielectric>(1.5);
-    auto key_light = std::make_shared<Emissive>(Vec3(1.0, 0.9, 0.8), 30.0);
+    uint32_t ground_diffuse = scene.materials.add(std::make_shared<Diffuse>(Vec3(0.2, 0.2, 0.2)));
+    uint32_t red_metal = scene.materials.add(std::make_shared<Metal>(Vec3(0.8, 0.2, 0.2), 0.1));
+    uint32_t blue_metal = scene.materials.add(std::make_shared<Metal>(Vec3(0.2, 0.2, 0.8), 0.3));
+    [[maybe_unused]] uint32_t glass_sphere = scene.materials.add(std::make_shared<Dielectric>(1.5));
+    uint32_t key_light = scene.materials.add(std::make_shared<Emissive>(Vec3(1.0, 0.9, 0.8), 30.0));
 
     // Ground (large sphere for ground plane)
     auto ground1 = std::make_shared<Triangle>(Vec3(-3, 0, -3), Vec3(3, 0, 3), Vec3(-3, 0, 3), ground_diffuse);
@@ -121,6 +259,83 @@ void SceneLoader::parse_json(Scene &scene, SceneConfig &config, nlohmann::json &
     {
         config.samples_per_pixel = json["nsamples"].get<int>();
     }
+    if (json.contains("seed"))
+    {
+        config.seed = json["seed"].get<unsigned int>();
+    }
+    if (json.contains("sampler"))
+    {
+        std::string sampler = json["sampler"].get<std::string>();
+        if (sampler == "random")
+        {
+            config.sampler = SamplerType::RANDOM;
+        }
+        else if (sampler == "sobol")
+        {
+            config.sampler = SamplerType::SOBOL;
+        }
+        else if (sampler == "halton")
+        {
+            config.sampler = SamplerType::HALTON;
+        }
+        else
+        {
+            std::cerr << "Warning: Unknown sampler '" << sampler << "'. Using random." << std::endl;
+            config.sampler = SamplerType::RANDOM;
+        }
+    }
+    if (json.contains("scheduler"))
+    {
+        std::string scheduler = json["scheduler"].get<std::string>();
+        if (scheduler == "tiles")
+        {
+            config.scheduler = RenderScheduler::TILES;
+        }
+        else if (scheduler == "scanlines")
+        {
+            config.scheduler = RenderScheduler::SCANLINES;
+        }
+        else
+        {
+            std::cerr << "Warning: Unknown scheduler '" << scheduler << "'. Using tiles." << std::endl;
+            config.scheduler = RenderScheduler::TILES;
+        }
+    }
+    if (json.contains("tile_size"))
+    {
+        config.tile_size = json["tile_size"].get<int>();
+        if (config.tile_size < 1)
+        {
+            std::cerr << "Warning: tile_size must be positive, got " << config.tile_size << ". Using 32." << std::endl;
+            config.tile_size = 32;
+        }
+    }
+    if (json.contains("time_budget_ms"))
+    {
+        config.time_budget_ms = json["time_budget_ms"].get<float>();
+    }
+    if (json.contains("progressive"))
+    {
+        config.progressive = json["progressive"].get<bool>();
+    }
+    if (json.contains("progressive_pass_samples"))
+    {
+        config.progressive_pass_samples = json["progressive_pass_samples"].get<int>();
+        if (config.progressive_pass_samples < 1)
+        {
+            std::cerr << "Warning: progressive_pass_samples must be positive, got " << config.progressive_pass_samples
+                      << ". Using 4." << std::endl;
+            config.progressive_pass_samples = 4;
+        }
+    }
+    if (json.contains("checkpoint"))
+    {
+        config.checkpoint_path = json["checkpoint"].get<std::string>();
+    }
+    if (json.contains("checkpoint_interval"))
+    {
+        config.checkpoint_interval = json["checkpoint_interval"].get<float>();
+    }
     if (json.contains("use_stratified_sampling"))
     {
         config.use_stratified_sampling = json["use_stratified_sampling"].get<bool>();
@@ -135,6 +350,59 @@ void SceneLoader::parse_json(Scene &scene, SceneConfig &config, nlohmann::json &
     {
         config.use_bvh = json["use_bvh"].get<bool>();
     }
+    if (json.contains("bvh_builder"))
+    {
+        std::string builder = json["bvh_builder"].get<std::string>();
+        if (builder == "median")
+        {
+            config.bvh_builder = BVHBuilder::MEDIAN;
+        }
+        else if (builder == "sah")
+        {
+            config.bvh_builder = BVHBuilder::SAH;
+        }
+        else if (builder == "lbvh")
+        {
+            config.bvh_builder = BVHBuilder::LBVH;
+        }
+        else if (builder == "hlbvh")
+        {
+            config.bvh_builder = BVHBuilder::HLBVH;
+        }
+        else
+        {
+            std::cerr << "Warning: Unknown bvh_builder '" << builder << "'. Using SAH." << std::endl;
+            config.bvh_builder = BVHBuilder::SAH;
+        }
+    }
+    if (json.contains("bvh_width"))
+    {
+        config.bvh_width = json["bvh_width"].get<int>();
+        if (config.bvh_width != 2 && config.bvh_width != 4 && config.bvh_width != 8)
+        {
+            std::cerr << "Warning: bvh_width must be 2, 4 or 8, got " << config.bvh_width << ". Using 2." << std::endl;
+            config.bvh_width = 2;
+        }
+    }
+    if (json.contains("use_bvh_cache"))
+    {
+        // A scene can opt out of the cache, but not re-enable it when it is disabled on the command line
+        config.use_bvh_cache = config.use_bvh_cache && json["use_bvh_cache"].get<bool>();
+    }
+    if (json.contains("bvh_cache_dir"))
+    {
+        config.bvh_cache_dir = json["bvh_cache_dir"].get<std::string>();
+    }
+    if (json.contains("bvh_cache_max_mb"))
+    {
+        config.bvh_cache_max_mb = json["bvh_cache_max_mb"].get<int>();
+        if (config.bvh_cache_max_mb < 0)
+        {
+            std::cerr << "Warning: bvh_cache_max_mb must not be negative, got " << config.bvh_cache_max_mb
+                      << ". Using 0 (no limit)." << std::endl;
+            config.bvh_cache_max_mb = 0;
+        }
+    }
     if (json.contains("use_denoiser"))
     {
         config.use_denoiser = json["use_denoiser"].get<bool>();
@@ -182,6 +450,14 @@ void SceneLoader::parse_json(Scene &scene, SceneConfig &config, nlohmann::json &
         {
             config.importance_threshold = json["importance_sampling_importance_threshold"].get<float>();
         }
+        if (json.contains("importance_sampling_batch_size"))
+        {
+            config.importance_batch_size = json["importance_sampling_batch_size"].get<int>();
+        }
+        if (json.contains("importance_sampling_heatmap"))
+        {
+            config.save_sample_heatmap = json["importance_sampling_heatmap"].get<bool>();
+        }
     }
     if (json.contains("rendermode"))
     {
@@ -215,6 +491,11 @@ void SceneLoader::parse_json(Scene &scene, SceneConfig &config, nlohmann::json &
     {
         parse_scene(scene, config, json["scene"]);
     }
+
+    if (config.progressive)
+    {
+        config.description_key = RenderCheckpoint::description_key(json);
+    }
 }
 
 void SceneLoader::parse_camera(Scene &scene, SceneConfig &config, const nlohmann::json &camera_json)
@@ -297,11 +578,135 @@ void SceneLoader::parse_scene(Scene &scene, SceneConfig &config, const nlohmann:
         parse_lights(scene, scene_json["lightsources"]);
     }
 
+    // Parse prototypes, which instances among the shapes refer to
+    prototypes.clear();
+    if (scene_json.contains("prototypes"))
+    {
+        parse_prototypes(scene, config, scene_json["prototypes"]);
+    }
+
     // Parse shapes
     if (scene_json.contains("shapes"))
     {
         parse_shapes(scene, config, scene_json["shapes"]);
     }
+
+    if (!prototypes.empty())
+    {
+        // Every instance shares its prototype's primitives, so only the prototypes count towards memory
+        size_t instance_count = 0;
+        size_t unique_primitives = 0;
+        size_t instanced_primitives = 0;
+        for (const auto &entry : prototypes)
+        {
+            instance_count += entry.second.instance_count;
+            unique_primitives += entry.second.object_count;
+            instanced_primitives += entry.second.instance_count * entry.second.object_count;
+        }
+        std::cout << "Instances: " << instance_count << " of " << prototypes.size() << " prototypes place "
+                  << instanced_primitives << " primitives, " << unique_primitives << " stored" << std::endl;
+    }
+}
+
+void SceneLoader::parse_prototypes(Scene &scene, SceneConfig &config, const nlohmann::json &prototypes_json)
+{
+    for (const auto &entry : prototypes_json.items())
+    {
+        const std::string &name = entry.key();
+        if (!entry.value().contains("shapes"))
+        {
+            std::cerr << "Error: Prototype '" << name << "' is missing 'shapes' field." << std::endl;
+            continue;
+        }
+
+        // The prototype's shapes are parsed into their own object list; materials and meshes stay with the scene
+        std::vector<std::shared_ptr<Hittable>> scene_objects;
+        scene_objects.swap(scene.objects);
+        parsing_prototype = true;
+        parse_shapes(scene, config, entry.value()["shapes"]);
+        parsing_prototype = false;
+        scene_objects.swap(scene.objects);
+
+        if (scene_objects.empty())
+        {
+            std::cerr << "Error: Prototype '" << name << "' has no shapes." << std::endl;
+            continue;
+        }
+
+        std::cout << "Prototype '" << name << "': " << scene_objects.size() << " objects" << std::endl;
+        Prototype prototype;
+        prototype.object_count = scene_objects.size();
+        prototype.root = scene_objects.size() == 1 ? scene_objects[0] : build_hierarchy(scene_objects, config);
+        prototypes[name] = prototype;
+    }
+}
+
+void SceneLoader::parse_instance(Scene &scene, const nlohmann::json &instance_json)
+{
+    if (parsing_prototype)
+    {
+        std::cerr << "Error: Instances cannot be nested inside prototypes." << std::endl;
+        return;
+    }
+    if (!instance_json.contains("prototype"))
+    {
+        std::cerr << "Error: Instance is missing 'prototype' field." << std::endl;
+        return;
+    }
+
+    std::string name = instance_json["prototype"].get<std::string>();
+    auto prototype = prototypes.find(name);
+    if (prototype == prototypes.end())
+    {
+        std::cerr << "Error: Instance refers to unknown prototype '" << name << "'." << std::endl;
+        return;
+    }
+
+    Transform object_to_world;
+    if (instance_json.contains("matrix"))
+    {
+        // Row-major 3x4: the linear part with the translation as a fourth column
+        const auto &matrix_json = instance_json["matrix"];
+        if (!matrix_json.is_array() || matrix_json.size() != 12)
+        {
+            std::cerr << "Error: Instance 'matrix' must have 12 values." << std::endl;
+            return;
+        }
+        float rows[12];
+        for (int i = 0; i < 12; ++i)
+            rows[i] = matrix_json[i].get<float>();
+        object_to_world = Transform(rows);
+    }
+    else
+    {
+        // Scaled, then rotated, then translated
+        Vec3 scale(1.0f);
+        if (instance_json.contains("scale"))
+        {
+            scale = instance_json["scale"].is_number() ? Vec3(instance_json["scale"].get<float>())
+                                                       : parse_vec3(instance_json["scale"]);
+        }
+        Vec3 rotation(0.0f);
+        if (instance_json.contains("rotation"))
+        {
+            rotation = parse_vec3(instance_json["rotation"]);
+        }
+        Vec3 translation(0.0f);
+        if (instance_json.contains("translation"))
+        {
+            translation = parse_vec3(instance_json["translation"]);
+        }
+        object_to_world = Transform::translation(translation) * Transform::rotation(rotation) * Transform::scaling(scale);
+    }
+
+    if (!std::isnormal(object_to_world.determinant()))
+    {
+        std::cerr << "Error: Instance of '" << name << "' has a transformation that cannot be inverted." << std::endl;
+        return;
+    }
+
+    scene.objects.push_back(std::make_shared<Instance>(prototype->second.root, object_to_world));
+    ++prototype->second.instance_count;
 }
 
 void SceneLoader::parse_lights(Scene &scene, const nlohmann::json &lights_json)
@@ -328,6 +733,13 @@ void SceneLoader::parse_shapes(Scene &scene, SceneConfig &config, const nlohmann
 {
     for (const auto &shape_json : shapes_json)
     {
+        // Instances take their materials from the prototype's shapes
+        if (shape_json.value("type", "") == "instance")
+        {
+            parse_instance(scene, shape_json);
+            continue;
+        }
+
         std::shared_ptr<Material> material;
 
         // Check if the "material" key exists
@@ -342,6 +754,7 @@ void SceneLoader::parse_shapes(Scene &scene, SceneConfig &config, const nlohmann
                 << "Warning: Shape of type '" << shape_json["type"].get<std::string>()
                 << "' is missing 'material' field. Using default red material." << std::endl;
         }
+        uint32_t material_id = scene.materials.add(material);
 
         // Continue parsing the shape
         if (!shape_json.contains("type"))
@@ -363,7 +776,7 @@ void SceneLoader::parse_shapes(Scene &scene, SceneConfig &config, const nlohmann
             Vec3 center = parse_vec3(shape_json["center"]);
             float radius = shape_json["radius"].get<float>();
 
-            scene.objects.push_back(std::make_shared<Sphere>(center, radius, material));
+            scene.objects.push_back(std::make_shared<Sphere>(center, radius, material_id));
         }
         else if (type == "cylinder")
         {
@@ -379,7 +792,7 @@ void SceneLoader::parse_shapes(Scene &scene, SceneConfig &config, const nlohmann
             float radius = shape_json["radius"].get<float>();
             float height = shape_json["height"].get<float>();
 
-            scene.objects.push_back(std::make_shared<Cylinder>(center, axis, radius, height, material));
+            scene.objects.push_back(std::make_shared<Cylinder>(center, axis, radius, height, material_id));
         }
         else if (type == "triangle")
         {
@@ -393,7 +806,7 @@ void SceneLoader::parse_shapes(Scene &scene, SceneConfig &config, const nlohmann
             Vec3 v1 = parse_vec3(shape_json["v1"]);
             Vec3 v2 = parse_vec3(shape_json["v2"]);
 
-            scene.objects.push_back(std::make_shared<Triangle>(v0, v1, v2, material));
+            scene.objects.push_back(std::make_shared<Triangle>(v0, v1, v2, material_id));
         }
         else if (type == "rectangle")
         {
@@ -405,14 +818,17 @@ void SceneLoader::parse_shapes(Scene &scene, SceneConfig &config, const nlohmann
                 Vec3 v2 = parse_vec3(shape_json["v2"]);
                 Vec3 v3 = parse_vec3(shape_json["v3"]);
 
-                scene.objects.push_back(std::make_shared<Rectangle>(v0, v1, v2, v3, material));
+                if ((v1 + v3 - v0 - v2).length() > 1e-4f * (v2 - v0).length())
+                    std::cerr << "Warning: Rectangle vertices do not form a parallelogram; v2 is taken as v1 + v3 - v0." << std::endl;
+
+                scene.objects.push_back(std::make_shared<Rectangle>(v0, v1, v2, v3, material_id));
             }
             else if (shape_json.contains("corner1") && shape_json.contains("corner2"))
             {
                 Vec3 corner1 = parse_vec3(shape_json["corner1"]);
                 Vec3 corner2 = parse_vec3(shape_json["corner2"]);
 
-                scene.objects.push_back(std::make_shared<Rectangle>(corner1, corner2, material));
+                scene.objects.push_back(std::make_shared<Rectangle>(corner1, corner2, material_id));
             }
             else
             {
@@ -438,7 +854,72 @@ void SceneLoader::parse_shapes(Scene &scene, SceneConfig &config, const nlohmann
                 rotation = parse_vec3(shape_json["rotation"]);
             }
 
-            scene.objects.push_back(std::make_shared<Box>(min, max, rotation, material));
+            scene.objects.push_back(std::make_shared<Box>(min, max, rotation, material_id));
+        }
+        else if (type == "plane")
+        {
+            if (!shape_json.contains("point") || !shape_json.contains("normal"))
+            {
+                std::cerr << "Error: Plane is missing 'point' or 'normal' field." << std::endl;
+                continue;
+            }
+
+            Vec3 point = parse_vec3(shape_json["point"]);
+            Vec3 normal = parse_vec3(shape_json["normal"]);
+
+            scene.objects.push_back(std::make_shared<Plane>(point, normal, material_id));
+        }
+        else if (type == "mesh")
+        {
+            auto mesh = std::make_unique<TriangleMesh>();
+            mesh->material_id = material_id;
+
+            // Meshes of .rtbin scenes refer to a buffer in the mapped file, others to a mesh file
+            if (binary && shape_json.contains("buffer"))
+            {
+                size_t buffer = shape_json["buffer"].get<size_t>();
+                if (buffer >= binary->mesh_count())
+                {
+                    std::cerr << "Error: Mesh refers to missing buffer " << buffer << "." << std::endl;
+                    continue;
+                }
+                binary->attach_mesh(buffer, *mesh);
+                TriangleMesh::create_faces(*mesh, scene.objects);
+                scene.meshes.push_back(std::move(mesh));
+                continue;
+            }
+
+            if (!shape_json.contains("file"))
+            {
+                std::cerr << "Error: Mesh is missing 'file' field." << std::endl;
+                continue;
+            }
+
+            std::string filename = shape_json["file"].get<std::string>();
+            auto start_time = std::chrono::high_resolution_clock::now();
+            if (!MeshLoader::load(filename, *mesh))
+            {
+                std::cerr << "Error: Failed to load mesh '" << filename << "'." << std::endl;
+                continue;
+            }
+            TriangleMesh::create_faces(*mesh, scene.objects);
+            auto end_time = std::chrono::high_resolution_clock::now();
+
+            // Each face costs its MeshTriangle, in one block shared by the mesh's faces, and its entry in the
+            // object list; a separate Triangle also needs its own make_shared control block (vtable pointer and
+            // two reference counts). The buffers are shared by all faces.
+            const size_t face_bytes = sizeof(MeshTriangle) + sizeof(std::shared_ptr<Hittable>);
+            const size_t triangle_bytes = sizeof(Triangle) + sizeof(void *) + 2 * sizeof(int) + sizeof(std::shared_ptr<Hittable>);
+            const size_t faces_count = mesh->face_count();
+            const double per_face = face_bytes + static_cast<double>(mesh->buffer_bytes()) / faces_count;
+            std::cout << "Loaded mesh '" << filename << "': " << faces_count << " triangles, "
+                      << mesh->vertex_count << " vertices in "
+                      << std::chrono::duration<double, std::milli>(end_time - start_time).count() << " ms" << std::endl;
+            std::cout << "  Memory: " << mesh->buffer_bytes() / 1024 << " KiB shared buffers + "
+                      << face_bytes * faces_count / 1024 << " KiB face references = " << per_face
+                      << " bytes per triangle (separate Triangle objects: " << triangle_bytes << ")" << std::endl;
+
+            scene.meshes.push_back(std::move(mesh));
         }
         else
         {
@@ -14,14 +14,32 @@
 #include "geometry/BVHNode.h"
 #include "core/PhongPathtracer.h"
 #include "core/Pathtracer.h"
+#include "core/TileScheduler.h"
 #include "postprocess/ReinhardToneMapper.h"
+#include "scene/BVHCache.h"
+#include "scene/RenderCheckpoint.h"
+#include "scene/SceneLoader.h"
 
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <cfloat>
 #include <chrono>
+#include <cmath>
 #include <iostream>
+#include <algorithm>
 #include <atomic>
+#include <iomanip>
+#include <numeric>
+#include <omp.h>
+
+namespace
+{
+/**
+ * The time kept free at the end of a time budget for each pixel of the output, to tone map and write it.
+ * Writing a tone mapped PPM measured about 260 ns per pixel; rounded up.
+ */
+constexpr double kOutputSecondsPerPixel = 350e-9;
+} // namespace
 
 void SceneRenderer::render(Scene &scene, SceneConfig &config, std::string &output_path)
 {
@@ -32,10 +50,62 @@ void SceneRenderer::render(Scene &scene, SceneConfig &config, std::string &outpu
               << " (Resolution: " << config.image_width << "x" << config.image_height << ")"
               << std::endl;
 
+    if (config.progressive && config.render_mode != RenderMode::PATH)
+    {
+        std::cerr << "Warning: Progressive rendering is only supported in path tracing mode. Rendering in one pass."
+                  << std::endl;
+    }
+    if (config.progressive && config.checkpoint_path.empty())
+    {
+        size_t dot = output_path.find_last_of('.');
+        config.checkpoint_path = output_path.substr(0, dot) + ".rtck";
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    float seconds = render_image(scene, config);
+    int total_pixels = config.image_width * config.image_height;
+    float avg_ms_per_pixel = seconds * 1000.0f / float(total_pixels);
+
+    std::cout << "\nRender complete!" << std::endl;
+    std::cout << "Total time: " << seconds << " seconds" << std::endl;
+    std::cout << "Average time per pixel: " << avg_ms_per_pixel << " ms" << std::endl;
+    std::cout << "Pixels per second: " << total_pixels / seconds << std::endl;
+
+    scene.image->save_ppm(output_path);
+
+    if (config.time_budget_ms > 0.0f && config.render_mode == RenderMode::PATH)
+    {
+        std::chrono::duration<float, std::milli> used = std::chrono::steady_clock::now() - start_time;
+        std::cout << "Time budget: finished in " << used.count() << " ms of " << config.time_budget_ms << " ms"
+                  << std::endl;
+    }
+
+    if (!sample_counts.empty())
+    {
+        long long total_samples = 0;
+        for (int count : sample_counts)
+            total_samples += count;
+        std::cout << "Adaptive sampling: " << float(total_samples) / total_pixels << " samples per pixel on average ("
+                  << *std::min_element(sample_counts.begin(), sample_counts.end()) << " to "
+                  << *std::max_element(sample_counts.begin(), sample_counts.end()) << ")" << std::endl;
+
+        if (config.save_sample_heatmap)
+        {
+            size_t dot = output_path.find_last_of('.');
+            std::string heatmap_path = output_path.substr(0, dot) + "_samples.ppm";
+            if (ImportanceSampler::save_heatmap(config, sample_counts, heatmap_path))
+                std::cout << "Sample heatmap saved to " << heatmap_path << std::endl;
+        }
+    }
+}
+
+float SceneRenderer::render_image(Scene &scene, SceneConfig &config)
+{
     auto start_time = std::chrono::high_resolution_clock::now();
 
     std::atomic<int> pixels_done = 0;
     int total_pixels = config.image_width * config.image_height;
+    sample_counts.clear();
 
     // Select render function based on mode
     if (config.render_mode == RenderMode::PHONG || config.render_mode == RenderMode::BINARY)
@@ -57,146 +127,491 @@ void SceneRenderer::render(Scene &scene, SceneConfig &config, std::string &outpu
 
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-    float seconds = duration.count() / 1000.0f;
-    float avg_ms_per_pixel = duration.count() / float(total_pixels);
+    return duration.count() / 1000.0f;
+}
 
-    std::cout << "\nRender complete!" << std::endl;
-    std::cout << "Total time: " << seconds << " seconds" << std::endl;
-    std::cout << "Average time per pixel: " << avg_ms_per_pixel << " ms" << std::endl;
-    std::cout << "Pixels per second: " << total_pixels / seconds << std::endl;
+int SceneRenderer::benchmark_schedulers(const std::string &scene_path, int max_threads)
+{
+    Scene scene;
+    SceneConfig config;
+    SceneLoader loader;
+    loader.load_scene_from_file(scene, config, scene_path);
+    if (!scene.camera || !scene.scene_root)
+    {
+        std::cerr << "Error: Could not load a renderable scene from '" << scene_path << "'." << std::endl;
+        return 1;
+    }
 
-    scene.image->save_ppm(output_path);
+    std::cout << "Scheduler benchmark: " << scene_path << " (" << config.image_width << "x" << config.image_height
+              << ", " << config.samples_per_pixel << " spp, " << config.tile_size << "px tiles, "
+              << omp_get_num_procs() << " processors)" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "scanlines (s)" << std::setw(12) << "tiles (s)"
+              << std::setw(10) << "speedup" << std::endl;
+
+    SceneRenderer renderer;
+    const RenderScheduler schedulers[] = {RenderScheduler::SCANLINES, RenderScheduler::TILES};
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        omp_set_num_threads(threads);
+        float seconds[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            config.scheduler = schedulers[i];
+            // Silence the progress output of the render itself
+            std::streambuf *console = std::cout.rdbuf(nullptr);
+            seconds[i] = renderer.render_image(scene, config);
+            std::cout.rdbuf(console);
+            std::cout.clear();
+        }
+        std::cout << std::setw(8) << threads << std::setw(14) << seconds[0] << std::setw(12) << seconds[1]
+                  << std::setw(10) << seconds[0] / seconds[1] << std::endl;
+    }
+    return 0;
+}
+
+template <typename TileFunction>
+void SceneRenderer::render_tiles(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels,
+                                 TileFunction compute_tile)
+{
+    if (config.scheduler == RenderScheduler::SCANLINES)
+    {
+#pragma omp parallel for schedule(dynamic)
+        for (int y = 0; y < config.image_height; ++y)
+        {
+            set_thread_sampler(config.sampler);
+            const Tile row{0, y, config.image_width, y + 1};
+            std::vector<Vec3> pixels(row.pixel_count());
+            compute_tile(row, pixels.data());
+
+            for (int x = 0; x < config.image_width; ++x)
+            {
+                scene.image->set_pixel(x, y, pixels[x]);
+            }
+            update_progress(pixels_done, total_pixels, row.pixel_count());
+        }
+        return;
+    }
+
+    const int n_threads = omp_get_max_threads();
+    TileScheduler scheduler(config.image_width, config.image_height, config.tile_size, n_threads);
+    const std::vector<Tile> &tiles = scheduler.tiles();
+    std::vector<std::vector<Vec3>> tile_pixels(tiles.size());
+
+#pragma omp parallel num_threads(n_threads)
+    {
+        set_thread_sampler(config.sampler);
+        const int worker = omp_get_thread_num();
+        int index;
+        while (scheduler.next(worker, index))
+        {
+            const Tile &tile = tiles[index];
+            std::vector<Vec3> &pixels = tile_pixels[index];
+            pixels.resize(tile.pixel_count());
+            compute_tile(tile, pixels.data());
+            update_progress(pixels_done, total_pixels, tile.pixel_count());
+        }
+    }
+
+    for (size_t t = 0; t < tiles.size(); ++t)
+    {
+        const Tile &tile = tiles[t];
+        size_t i = 0;
+        for (int y = tile.y0; y < tile.y1; ++y)
+        {
+            for (int x = tile.x0; x < tile.x1; ++x)
+            {
+                scene.image->set_pixel(x, y, tile_pixels[t][i++]);
+            }
+        }
+    }
+}
+
+template <typename PixelFunction>
+void SceneRenderer::render_pixels(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels,
+                                  PixelFunction compute_pixel)
+{
+    render_tiles(scene, config, pixels_done, total_pixels,
+                 [&](const Tile &tile, Vec3 *pixels)
+                 {
+                     for (int y = tile.y0; y < tile.y1; ++y)
+                     {
+                         for (int x = tile.x0; x < tile.x1; ++x)
+                         {
+                             *pixels++ = compute_pixel(x, y);
+                         }
+                     }
+                 });
 }
 
 void SceneRenderer::render_path(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels)
 {
-    Pathtracer path_tracer(config);
+    Pathtracer path_tracer(config, scene.materials);
     std::unique_ptr<ImportanceSampler> importance_sampler;
+    if (config.time_budget_ms > 0.0f)
+    {
+        if (config.progressive || config.use_importance_sampling)
+        {
+            std::cerr << "Warning: time_budget_ms replaces progressive rendering and importance sampling." << std::endl;
+        }
+        render_path_budgeted(scene, config, path_tracer);
+        return;
+    }
+    if (config.progressive && config.use_importance_sampling)
+    {
+        std::cerr << "Warning: Progressive rendering does not support importance sampling. Rendering in one pass."
+                  << std::endl;
+    }
+    else if (config.progressive)
+    {
+        render_path_progressive(scene, config, path_tracer);
+        return;
+    }
+
+    // The number of adaptive samples is open ended, so they are jittered rather than stratified
+    SceneConfig jittered = config;
+    if (config.use_importance_sampling && config.use_stratified_sampling)
+    {
+        std::cerr << "Warning: Importance sampling does not support stratified sampling. Jittering samples instead."
+                  << std::endl;
+        jittered.use_stratified_sampling = false;
+    }
+
     if (config.use_importance_sampling)
     {
         importance_sampler = std::make_unique<ImportanceSampler>(config);
-        std::cout << "Rendering using path tracing with importance sampling..." << std::endl;
+        sample_counts.assign(static_cast<size_t>(config.image_width) * config.image_height, 0);
+        std::cout << "Rendering using path tracing with adaptive sampling..." << std::endl;
     }
     else
     {
         std::cout << "Rendering using path tracing..." << std::endl;
     }
 
-#pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < config.image_height; ++y)
+    if (importance_sampler)
     {
-        for (int x = 0; x < config.image_width; ++x)
+        render_tiles(scene, config, pixels_done, total_pixels,
+                     [&](const Tile &tile, Vec3 *pixels)
+                     { sample_tile(tile, pixels, scene, jittered, path_tracer, *importance_sampler); });
+    }
+    else
+    {
+        render_pixels(scene, config, pixels_done, total_pixels,
+                      [&](int x, int y) { return sample_pixel(x, y, scene, config, path_tracer); });
+    }
+}
+
+void SceneRenderer::sample_tile(const Tile &tile, Vec3 *pixels, Scene &scene, SceneConfig &config,
+                                Pathtracer &path_tracer, const ImportanceSampler &importance_sampler)
+{
+    const int count = tile.pixel_count();
+    std::vector<ImportanceSampler::SampleStats> stats(count);
+
+    // Every pixel of the tile takes each batch, until the tile's error estimate is small enough
+    int samples = 0;
+    for (int batch_end = importance_sampler.next_batch_end(0, INFINITY); samples < batch_end;
+         batch_end = importance_sampler.next_batch_end(samples, importance_sampler.tile_error(stats.data(), count)))
+    {
+        sample_tile_batch(tile, stats.data(), samples, batch_end, scene, config, path_tracer, importance_sampler);
+        samples = batch_end;
+    }
+
+    int i = 0;
+    for (int y = tile.y0; y < tile.y1; ++y)
+    {
+        for (int x = tile.x0; x < tile.x1; ++x, ++i)
         {
-            Vec3 pixel_color(0, 0, 0);
-            float num_samples;
+            pixels[i] = stats[i].sum / float(samples);
+            sample_counts[static_cast<size_t>(y) * config.image_width + x] = samples;
+        }
+    }
+}
+
+void SceneRenderer::render_path_progressive(Scene &scene, SceneConfig &config, Pathtracer &path_tracer)
+{
+    using Clock = std::chrono::steady_clock;
+    const int target = config.use_stratified_sampling ? config.sqrt_samples * config.sqrt_samples
+                                                      : config.samples_per_pixel;
+    const int total_pixels = config.image_width * config.image_height;
+    const bool keep_checkpoint = !config.checkpoint_path.empty();
+
+    RenderCheckpoint checkpoint(config, BVHCache::bounds_key(scene.objects));
+    if (keep_checkpoint && config.resume && checkpoint.load(config.checkpoint_path, static_cast<uint32_t>(target)))
+    {
+        std::cout << "Resuming from checkpoint " << config.checkpoint_path << " at " << checkpoint.min_samples()
+                  << " samples per pixel" << std::endl;
+    }
+    std::cout << "Rendering using progressive path tracing..." << std::endl;
+
+    // A pass also runs when the checkpoint is already complete, to fill the image from it
+    int done = static_cast<int>(checkpoint.min_samples());
+    auto last_save = Clock::now();
+    do
+    {
+        const int pass_end = std::min(done + std::max(config.progressive_pass_samples, 1), target);
+        std::atomic<int> pixels_done = 0;
+        render_tiles(scene, config, pixels_done, total_pixels,
+                     [&](const Tile &tile, Vec3 *pixels)
+                     {
+                         for (int y = tile.y0; y < tile.y1; ++y)
+                         {
+                             for (int x = tile.x0; x < tile.x1; ++x)
+                             {
+                                 const size_t p = static_cast<size_t>(y) * config.image_width + x;
+                                 Vec3 &sum = checkpoint.sums[p];
+                                 uint32_t &count = checkpoint.counts[p];
+                                 // Summing in sample order keeps the float sum identical to sample_pixel's
+                                 for (; count < static_cast<uint32_t>(pass_end); ++count)
+                                 {
+                                     sum += trace_sample(x, y, static_cast<int>(count), scene, config, path_tracer);
+                                 }
+                                 Vec3 color = sum;
+                                 color /= float(count);
+                                 *pixels++ = color;
+                             }
+                         }
+                     });
+        done = std::max(done, pass_end);
+
+        std::chrono::duration<float> since_save = Clock::now() - last_save;
+        bool saved = false;
+        if (keep_checkpoint && (done >= target || since_save.count() >= config.checkpoint_interval))
+        {
+            saved = checkpoint.save(config.checkpoint_path);
+            last_save = Clock::now();
+        }
+        std::cout << "\rPass complete: " << done << "/" << target << " samples per pixel"
+                  << (saved ? " (checkpoint saved)" : "") << std::endl;
+    } while (done < target);
+}
+
+void SceneRenderer::render_path_budgeted(Scene &scene, SceneConfig &config, Pathtracer &path_tracer)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const int total_pixels = config.image_width * config.image_height;
+    const std::chrono::duration<double> render_budget(config.time_budget_ms / 1000.0 -
+                                                      total_pixels * kOutputSecondsPerPixel);
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(render_budget);
+    std::cout << "Rendering using path tracing within " << config.time_budget_ms << " ms..." << std::endl;
+
+    // The number of samples is open ended, so they are jittered rather than stratified
+    SceneConfig jittered = config;
+    jittered.use_stratified_sampling = false;
+
+    const ImportanceSampler importance_sampler(config);
+    const TileScheduler scheduler(config.image_width, config.image_height, config.tile_size, 1);
+    const std::vector<Tile> &tiles = scheduler.tiles();
+    const int n_tiles = static_cast<int>(tiles.size());
+    std::vector<std::vector<ImportanceSampler::SampleStats>> stats(n_tiles);
+    for (int t = 0; t < n_tiles; ++t)
+    {
+        stats[t].resize(tiles[t].pixel_count());
+    }
+    std::vector<int> samples(n_tiles, 0);
+    std::vector<float> errors(n_tiles, INFINITY);
+    std::vector<double> tile_seconds(n_tiles, 0.0);
+    std::vector<double> priorities(n_tiles, 0.0);
+    std::vector<int> order(n_tiles);
+    std::iota(order.begin(), order.end(), 0);
 
-            if (config.use_importance_sampling)
+    std::atomic<bool> out_of_time = false;
+    int rounds = 0;
+    for (; !out_of_time; ++rounds)
+    {
+        // The first round gives every pixel the two samples an error estimate needs, however long they take
+        int selected = n_tiles;
+        int pass = 2;
+        if (rounds > 0)
+        {
+            // A pass cuts a tile's squared error by the factor pass / (samples + pass), for a cost of pass times
+            // its time per sample, so the half of the noisy tiles with the best ratio goes next
+            pass = std::max(config.progressive_pass_samples, 1);
+            int noisy = 0;
+            for (int t = 0; t < n_tiles; ++t)
             {
-                // Get initial sample for importance
-                float u = (float(x) + random_float()) / (config.image_width - 1);
-                float v = (float(y) + random_float()) / (config.image_height - 1);
-                Ray r = scene.camera->get_ray(u, v);
-                Vec3 first_sample = path_tracer.trace(r, *scene.scene_root, config.max_ray_depth, scene.lights);
-                pixel_color = first_sample;
-
-                float importance = importance_sampler->calculate_importance(first_sample);
-                num_samples = std::max(
-                    float(config.min_samples),
-                    std::min(importance * config.samples_per_pixel, float(config.max_samples)));
-
-                // Additional samples
-                for (int s = 1; s < static_cast<int>(num_samples); ++s)
-                {
-                    float u = (float(x) + random_float()) / (config.image_width - 1);
-                    float v = (float(y) + random_float()) / (config.image_height - 1);
-                    Ray r = scene.camera->get_ray(u, v);
-                    pixel_color += path_tracer.trace(r, *scene.scene_root, config.max_ray_depth, scene.lights);
-                }
+                const double seconds_per_sample =
+                    std::max(tile_seconds[t] / (double(samples[t]) * tiles[t].pixel_count()), 1e-12);
+                priorities[t] = double(errors[t]) * errors[t] / ((samples[t] + pass) * seconds_per_sample);
+                noisy += errors[t] > 0.0f;
             }
-            else
+            if (noisy == 0)
             {
-                num_samples = config.use_stratified_sampling ? config.sqrt_samples_squared : config.samples_per_pixel;
+                break;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return priorities[a] > priorities[b]; });
+            selected = (noisy + 1) / 2;
+        }
 
-                if (config.use_stratified_sampling)
-                {
-                    for (int sy = 0; sy < config.sqrt_samples; ++sy)
-                    {
-                        for (int sx = 0; sx < config.sqrt_samples; ++sx)
-                        {
-                            float r1 = random_float() * config.inv_sqrt_samples;
-                            float r2 = random_float() * config.inv_sqrt_samples;
-
-                            float u = (float(x) + (sx * config.inv_sqrt_samples + r1)) / (config.image_width - 1);
-                            float v = (float(y) + (sy * config.inv_sqrt_samples + r2)) / (config.image_height - 1);
-                            Ray r = scene.camera->get_ray(u, v);
-                            pixel_color += path_tracer.trace(r, *scene.scene_root, config.max_ray_depth, scene.lights);
-                        }
-                    }
-                }
-                else
+#pragma omp parallel
+        {
+            set_thread_sampler(config.sampler);
+#pragma omp for schedule(dynamic)
+            for (int i = 0; i < selected; ++i)
+            {
+                const int t = order[i];
+                const Tile &tile = tiles[t];
+                const auto tile_start = Clock::now();
+                if (rounds > 0)
                 {
-                    for (int s = 0; s < config.samples_per_pixel; ++s)
+                    const std::chrono::duration<double> expected(tile_seconds[t] * pass / samples[t]);
+                    if (out_of_time || tile_start + std::chrono::duration_cast<Clock::duration>(expected) > deadline)
                     {
-                        float u = (float(x) + random_float()) / (config.image_width - 1);
-                        float v = (float(y) + random_float()) / (config.image_height - 1);
-                        Ray r = scene.camera->get_ray(u, v);
-                        pixel_color += path_tracer.trace(r, *scene.scene_root, config.max_ray_depth, scene.lights);
+                        out_of_time = true;
+                        continue;
                     }
                 }
+
+                sample_tile_batch(tile, stats[t].data(), samples[t], samples[t] + pass, scene, jittered, path_tracer,
+                                  importance_sampler);
+                samples[t] += pass;
+                // A NaN sample would make the tile unorderable; such a tile cannot improve anyway
+                const float error = importance_sampler.tile_error(stats[t].data(), tile.pixel_count());
+                errors[t] = std::isnan(error) ? 0.0f : error;
+
+                tile_seconds[t] += std::chrono::duration<double>(Clock::now() - tile_start).count();
             }
+        }
 
-            pixel_color /= num_samples;
-            scene.image->set_pixel(x, y, pixel_color);
-            update_progress(pixels_done, total_pixels);
+        if (rounds == 0 && Clock::now() > deadline)
+        {
+            std::cerr << "Warning: The time budget is too short for two samples per pixel." << std::endl;
+            out_of_time = true;
+        }
+    }
+
+    sample_counts.assign(static_cast<size_t>(total_pixels), 0);
+    double squared_error = 0.0;
+    float worst_error = 0.0f;
+    for (int t = 0; t < n_tiles; ++t)
+    {
+        const Tile &tile = tiles[t];
+        int i = 0;
+        for (int y = tile.y0; y < tile.y1; ++y)
+        {
+            for (int x = tile.x0; x < tile.x1; ++x, ++i)
+            {
+                Vec3 color = stats[t][i].sum;
+                color /= float(samples[t]);
+                scene.image->set_pixel(x, y, color);
+                sample_counts[static_cast<size_t>(y) * config.image_width + x] = samples[t];
+            }
         }
+        squared_error += double(errors[t]) * errors[t] * tile.pixel_count();
+        worst_error = std::max(worst_error, errors[t]);
     }
+
+    std::cout << "Time budget: " << rounds << " rounds, estimated relative error "
+              << std::sqrt(squared_error / total_pixels) << " (noisiest tile " << worst_error << ")" << std::endl;
 }
 
-void SceneRenderer::render_phong_or_binary(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels)
+void SceneRenderer::sample_tile_batch(const Tile &tile, ImportanceSampler::SampleStats *stats, int samples,
+                                      int batch_end, Scene &scene, SceneConfig &config, Pathtracer &path_tracer,
+                                      const ImportanceSampler &importance_sampler)
 {
-    // #pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < config.image_height; ++y)
+    int i = 0;
+    for (int y = tile.y0; y < tile.y1; ++y)
     {
-        for (int x = 0; x < config.image_width; ++x)
+        for (int x = tile.x0; x < tile.x1; ++x, ++i)
         {
-            Vec3 pixel_color(0, 0, 0);
-            for (int s = 0; s < config.samples_per_pixel; ++s)
+            for (int s = samples; s < batch_end; ++s)
             {
-                float u = (float(x) + random_float()) / (config.image_width - 1);
-                float v = (float(y) + random_float()) / (config.image_height - 1);
-                Ray r = scene.camera->get_ray(u, v);
-
-                HitRecord rec;
-                if (scene.scene_root->hit(r, 0.001, FLT_MAX, rec))
-                {
-                    Vec3 view_dir = -r.direction().normalized();
-                    pixel_color += rec.material_ptr->shade(rec, view_dir, scene.lights, *scene.scene_root, config.max_ray_depth, config);
-                }
-                else
-                {
-                    pixel_color += compute_background_color(config, r);
-                }
+                importance_sampler.add_sample(stats[i], trace_sample(x, y, s, scene, config, path_tracer));
             }
+        }
+    }
+}
 
-            pixel_color /= float(config.samples_per_pixel);
-            scene.image->set_pixel(x, y, pixel_color);
+Vec3 SceneRenderer::sample_pixel(int x, int y, Scene &scene, SceneConfig &config, Pathtracer &path_tracer)
+{
+    Vec3 pixel_color(0, 0, 0);
+    float num_samples = config.use_stratified_sampling ? config.sqrt_samples_squared : config.samples_per_pixel;
+    const int n = config.use_stratified_sampling ? config.sqrt_samples * config.sqrt_samples : config.samples_per_pixel;
 
-            update_progress(pixels_done, total_pixels);
+    for (int s = 0; s < n; ++s)
+    {
+        pixel_color += trace_sample(x, y, s, scene, config, path_tracer);
+    }
+
+    pixel_color /= num_samples;
+    return pixel_color;
+}
+
+Vec3 SceneRenderer::trace_sample(int x, int y, int s, Scene &scene, SceneConfig &config, Pathtracer &path_tracer)
+{
+    begin_sample(config.seed, static_cast<uint64_t>(y) * config.image_width + x, s);
+    float u, v;
+    if (config.use_stratified_sampling)
+    {
+        const int sx = s % config.sqrt_samples;
+        const int sy = s / config.sqrt_samples;
+        float r1, r2;
+        random_float2(r1, r2);
+        r1 *= config.inv_sqrt_samples;
+        r2 *= config.inv_sqrt_samples;
+
+        u = (float(x) + (sx * config.inv_sqrt_samples + r1)) / (config.image_width - 1);
+        v = (float(y) + (sy * config.inv_sqrt_samples + r2)) / (config.image_height - 1);
+    }
+    else
+    {
+        float jitter_x, jitter_y;
+        random_float2(jitter_x, jitter_y);
+        u = (float(x) + jitter_x) / (config.image_width - 1);
+        v = (float(y) + jitter_y) / (config.image_height - 1);
+    }
+    Ray r = scene.camera->get_ray(u, v);
+    return path_tracer.trace(r, *scene.scene_root, config.max_ray_depth, scene.lights);
+}
+
+void SceneRenderer::render_phong_or_binary(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels)
+{
+    render_pixels(scene, config, pixels_done, total_pixels,
+                  [&](int x, int y) { return shade_pixel(x, y, scene, config); });
+}
+
+Vec3 SceneRenderer::shade_pixel(int x, int y, Scene &scene, SceneConfig &config) const
+{
+    const uint64_t pixel_index = static_cast<uint64_t>(y) * config.image_width + x;
+    Vec3 pixel_color(0, 0, 0);
+    for (int s = 0; s < config.samples_per_pixel; ++s)
+    {
+        begin_sample(config.seed, pixel_index, s);
+        float jitter_x, jitter_y;
+        random_float2(jitter_x, jitter_y);
+        float u = (float(x) + jitter_x) / (config.image_width - 1);
+        float v = (float(y) + jitter_y) / (config.image_height - 1);
+        Ray r = scene.camera->get_ray(u, v);
+
+        HitRecord rec;
+        if (scene.scene_root->hit(r, 0.001, FLT_MAX, rec))
+        {
+            rec.primitive->compute_interaction(r, rec, scene.materials);
+            Vec3 view_dir = -r.direction().normalized();
+            pixel_color += scene.materials[rec.material_id].shade(rec, view_dir, scene.lights, *scene.scene_root, scene.materials, config.max_ray_depth, config);
+        }
+        else
+        {
+            pixel_color += compute_background_color(config, r);
         }
     }
+
+    pixel_color /= float(config.samples_per_pixel);
+    return pixel_color;
 }
 
 // DO NOT UPDATE THIS FUNCTION, USE REAL PATH TRACING INSTEAD
 void SceneRenderer::render_phongpath(Scene &scene, SceneConfig &config, std::atomic<int> &pixels_done, int total_pixels)
 {
-    PhongPathtracer path_tracer(config.max_ray_depth);
+    PhongPathtracer path_tracer(config.max_ray_depth, scene.materials);
     std::cout << "Rendering using path tracing..." << std::endl;
 
 #pragma omp parallel for schedule(dynamic)
     for (int y = 0; y < config.image_height; ++y)
     {
+        set_thread_sampler(config.sampler);
         for (int x = 0; x < config.image_width; ++x)
         {
+            const uint64_t pixel_index = static_cast<uint64_t>(y) * config.image_width + x;
             Vec3 pixel_color(0, 0, 0);
 
             if (config.use_stratified_sampling)
@@ -208,8 +623,11 @@ void SceneRenderer::render_phongpath(Scene &scene, SceneConfig &config, std::ato
                 {
                     for (int sx = 0; sx < sqrt_samples; ++sx)
                     {
-                        float u = (float(x) + (sx + random_float()) * inv_sqrt_samples) / (config.image_width - 1);
-                        float v = (float(y) + (sy + random_float()) * inv_sqrt_samples) / (config.image_height - 1);
+                        begin_sample(config.seed, pixel_index, sy * sqrt_samples + sx);
+                        float jitter_x, jitter_y;
+                        random_float2(jitter_x, jitter_y);
+                        float u = (float(x) + (sx + jitter_x) * inv_sqrt_samples) / (config.image_width - 1);
+                        float v = (float(y) + (sy + jitter_y) * inv_sqrt_samples) / (config.image_height - 1);
                         Ray r = scene.camera->get_ray(u, v);
                         pixel_color += path_tracer.trace(r, *scene.scene_root, config.max_ray_depth, config, scene.lights);
                     }
@@ -221,8 +639,11 @@ void SceneRenderer::render_phongpath(Scene &scene, SceneConfig &config, std::ato
             {
                 for (int s = 0; s < config.samples_per_pixel; ++s)
                 {
-                    float u = (float(x) + random_float()) / (config.image_width - 1);
-                    float v = (float(y) + random_float()) / (config.image_height - 1);
+                    begin_sample(config.seed, pixel_index, s);
+                    float jitter_x, jitter_y;
+                    random_float2(jitter_x, jitter_y);
+                    float u = (float(x) + jitter_x) / (config.image_width - 1);
+                    float v = (float(y) + jitter_y) / (config.image_height - 1);
 
                     Ray r = scene.camera->get_ray(u, v);
                     pixel_color += path_tracer.trace(r, *scene.scene_root, config.max_ray_depth, config, scene.lights);
@@ -238,10 +659,11 @@ void SceneRenderer::render_phongpath(Scene &scene, SceneConfig &config, std::ato
     }
 }
 
-void SceneRenderer::update_progress(std::atomic<int> &pixels_done, int total_pixels)
+void SceneRenderer::update_progress(std::atomic<int> &pixels_done, int total_pixels, int count)
 {
-    int done = ++pixels_done;
-    if (done % (total_pixels / 100) == 0) // Update every 1% of total progress
+    int done = pixels_done += count;
+    int step = std::max(total_pixels / 100, 1);
+    if (done / step != (done - count) / step) // Update every 1% of total progress
     {
         std::lock_guard<std::mutex> lock(console_mutex);
         std::cout << "\rProgress: " << (done * 100) / total_pixels << "% " << std::flush;
@@ -0,0 +1,125 @@
+#include "core/Pathtracer.h"
+#include "core/Utils.h"
+#include "scene/Scene.h"
+#include "scene/SceneConfig.h"
+#include "scene/SceneLoader.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+/**
+ * Counts heap allocations made through operator new while tracing paths, to check that the sampling loop does
+ * not allocate once its thread-local buffers have grown to the longest path. Every sample of a block of pixels
+ * is traced once to warm up, then a further set of samples is traced and the count must not change.
+ *
+ * Usage: tests/alloc_count.exe [scene] [samples_per_pixel]
+ */
+
+namespace
+{
+std::atomic<size_t> allocations{0};
+}
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+constexpr int kBlockSize = 64; ///< Side of the block of pixels at the centre of the image that is traced.
+
+/**
+ * Traces samples [first, last) of every pixel in the block and returns their sum, so the work is not optimised
+ * away.
+ */
+Vec3 trace_block(Scene &scene, SceneConfig &config, Pathtracer &path_tracer, uint32_t first, uint32_t last)
+{
+    Vec3 total(0, 0, 0);
+    const int x0 = (config.image_width - kBlockSize) / 2;
+    const int y0 = (config.image_height - kBlockSize) / 2;
+    for (int y = y0; y < y0 + kBlockSize; ++y)
+    {
+        for (int x = x0; x < x0 + kBlockSize; ++x)
+        {
+            for (uint32_t s = first; s < last; ++s)
+            {
+                begin_sample(config.seed, static_cast<uint64_t>(y) * config.image_width + x, s);
+                float jitter_x, jitter_y;
+                random_float2(jitter_x, jitter_y);
+                float u = (float(x) + jitter_x) / (config.image_width - 1);
+                float v = (float(y) + jitter_y) / (config.image_height - 1);
+                Ray r = scene.camera->get_ray(u, v);
+                total += path_tracer.trace(r, *scene.scene_root, config.max_ray_depth, scene.lights);
+            }
+        }
+    }
+    return total;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::string scene_path = argc > 1 ? argv[1] : "scenes/cornell_box.json";
+    const uint32_t samples = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 16;
+
+    Scene scene;
+    SceneConfig config;
+    config.use_bvh_cache = false;
+    SceneLoader loader;
+    loader.load_scene_from_file(scene, config, scene_path);
+    if (!scene.camera || !scene.scene_root || config.image_width < kBlockSize || config.image_height < kBlockSize)
+    {
+        std::cerr << "Error: Could not load a renderable scene from '" << scene_path << "'." << std::endl;
+        return 1;
+    }
+
+    Pathtracer path_tracer(config, scene.materials);
+    set_thread_sampler(config.sampler);
+
+    Vec3 warm_up = trace_block(scene, config, path_tracer, 0, samples);
+    const size_t before = allocations;
+    Vec3 measured = trace_block(scene, config, path_tracer, samples, 2 * samples);
+    const size_t after = allocations;
+
+    const size_t paths = static_cast<size_t>(kBlockSize) * kBlockSize * samples;
+    std::cout << scene_path << ": " << after - before << " allocations in " << paths << " paths after warm-up"
+              << " (checksum " << warm_up.x + measured.x + warm_up.y + measured.y << ")" << std::endl;
+    if (after != before)
+    {
+        std::cerr << "FAIL: the sampling loop allocates on the heap." << std::endl;
+        return 1;
+    }
+    std::cout << "OK" << std::endl;
+    return 0;
+}
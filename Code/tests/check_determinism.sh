@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+# Renders every scene in scenes/ with OMP_NUM_THREADS=1 and with N threads and fails if the two images differ
+# in any byte. Scenes are shrunk to 1/DIVISOR of their resolution and at most MAX_SAMPLES samples per pixel so
+# the whole set renders in a few minutes. Scenes that cannot be rendered even on one thread are skipped.
+#
+# Usage: tests/check_determinism.sh [raytracer] [threads] [divisor] [max_samples]
+
+set -u
+cd "$(dirname "$0")/.."
+
+raytracer=$(realpath "${1:-./raytracer.exe}")
+threads=${2:-8}
+divisor=${3:-8}
+max_samples=${4:-16}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+# Scenes refer to meshes and textures relative to the working directory
+ln -s "$PWD/scenes" "$work/scenes"
+ln -s "$PWD/textures" "$work/textures"
+
+passed=0
+failed=0
+skipped=0
+for scene in scenes/*.json; do
+    name=$(basename "$scene" .json)
+    python3 - "$scene" "$work/$name.json" "$divisor" "$max_samples" <<'PY'
+import json, sys
+scene = json.load(open(sys.argv[1]))
+divisor, max_samples = int(sys.argv[3]), int(sys.argv[4])
+camera = scene.setdefault("camera", {})
+camera["width"] = max(16, camera.get("width", 1920) // divisor)
+camera["height"] = max(16, camera.get("height", 1080) // divisor)
+for key in ("nsamples", "importance_sampling_min_samples", "importance_sampling_max_samples"):
+    if key in scene:
+        scene[key] = min(scene[key], max_samples)
+json.dump(scene, open(sys.argv[2], "w"))
+PY
+
+    for n in 1 "$threads"; do
+        rm -f "$work/output.ppm"
+        if (cd "$work" && OMP_NUM_THREADS=$n "$raytracer" "$name.json" --no-bvh-cache >"$name.$n.log" 2>&1) &&
+           [ -f "$work/output.ppm" ]; then
+            mv "$work/output.ppm" "$work/$name.$n.ppm"
+        fi
+    done
+
+    if [ ! -f "$work/$name.1.ppm" ]; then
+        echo "SKIP  $name (does not render on one thread)"
+        skipped=$((skipped + 1))
+    elif [ ! -f "$work/$name.$threads.ppm" ]; then
+        echo "FAIL  $name (renders on one thread but not on $threads)"
+        failed=$((failed + 1))
+    elif cmp -s "$work/$name.1.ppm" "$work/$name.$threads.ppm"; then
+        echo "OK    $name"
+        passed=$((passed + 1))
+    else
+        echo "FAIL  $name ($(cmp "$work/$name.1.ppm" "$work/$name.$threads.ppm" 2>&1 | head -n 1))"
+        failed=$((failed + 1))
+    fi
+done
+
+echo "$passed identical, $failed different, $skipped skipped (1 vs $threads threads)"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,198 @@
+#include "geometry/LinearBVH.h"
+#include "geometry/Sphere.h"
+#include "geometry/WideBVH.h"
+#include "scene/SceneBinary.h"
+#include "scene/SceneConfig.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+/**
+ * Writes BVH files for a cloud of spheres at widths 2, 4 and 8 and checks that SceneBinary adopts each intact
+ * file but rejects corrupted copies. The corruptions keep every link pointing forward and in range, so they
+ * pass all but the structural checks: a node named as a child by two parents would be validated at the depth
+ * of one parent and traversed at the depth of the other, overrunning the traversal stack.
+ *
+ * Usage: tests/rtbin_validation.exe [directory]
+ */
+
+namespace
+{
+constexpr int kSpheres = 2000; ///< Enough objects for a tree several levels deep at every width.
+
+/**
+ * Reads a file into memory.
+ */
+std::vector<char> read_file(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Returns the file offset of the first node of the file's BVH.
+ */
+uint64_t nodes_offset(const std::vector<char> &image)
+{
+    RtbinHeader header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    RtbinBVH record;
+    std::memcpy(&record, image.data() + header.bvh_offset, sizeof(record));
+    return record.nodes_offset;
+}
+
+/**
+ * Copies node i of an image out of or back into the file's node array.
+ */
+template <typename Node>
+Node get_node(const std::vector<char> &image, size_t i)
+{
+    Node node;
+    std::memcpy(&node, image.data() + nodes_offset(image) + i * sizeof(Node), sizeof(Node));
+    return node;
+}
+
+template <typename Node>
+void set_node(std::vector<char> &image, size_t i, const Node &node)
+{
+    std::memcpy(image.data() + nodes_offset(image) + i * sizeof(Node), &node, sizeof(Node));
+}
+
+/**
+ * Makes a node inside the root's first subtree take the root's second child as its own second child.
+ */
+bool share_binary_child(std::vector<char> &image, size_t node_count)
+{
+    const auto root = get_node<LinearBVHNode>(image, 0);
+    if (root.n_primitives > 0)
+        return false;
+    const size_t shared = static_cast<size_t>(root.second_child_offset);
+    for (size_t j = 1; j + 1 < shared && j < node_count; ++j)
+    {
+        auto node = get_node<LinearBVHNode>(image, j);
+        if (node.n_primitives > 0)
+            continue;
+        node.second_child_offset = static_cast<int32_t>(shared);
+        set_node(image, j, node);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Points an interior slot of a wide node at a later interior node that already has another parent.
+ */
+template <int Width>
+bool share_wide_child(std::vector<char> &image, size_t node_count)
+{
+    using Node = WideBVHNode<Width>;
+    std::vector<int64_t> parent(node_count, -1);
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        const Node node = get_node<Node>(image, i);
+        for (int c = 0; c < Width; ++c)
+            if (node.children[c] >= 0 && node.counts[c] == 0)
+                parent[node.children[c]] = static_cast<int64_t>(i);
+    }
+
+    for (size_t j = 1; j < node_count; ++j)
+    {
+        Node node = get_node<Node>(image, j);
+        for (int c = 0; c < Width; ++c)
+        {
+            if (node.children[c] < 0 || node.counts[c] != 0)
+                continue;
+            for (size_t x = j + 1; x < node_count; ++x)
+            {
+                if (parent[x] < 0 || parent[x] == static_cast<int64_t>(j))
+                    continue;
+                node.children[c] = static_cast<int32_t>(x);
+                set_node(image, j, node);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Builds, writes and corrupts the BVH of one width. Returns the number of failed checks.
+ */
+template <int Width>
+int check_width(const std::vector<std::shared_ptr<Hittable>> &objects, const std::string &directory)
+{
+    SceneConfig config;
+    config.bvh_width = Width;
+    std::shared_ptr<Hittable> root;
+    if constexpr (Width == 2)
+        root = std::make_shared<LinearBVH>(objects, config.bvh_builder);
+    else
+        root = std::make_shared<WideBVH<Width>>(objects, config.bvh_builder);
+
+    const std::string intact = directory + "/rtbin_validation_" + std::to_string(Width) + ".rtbin";
+    const std::string corrupt = directory + "/rtbin_validation_" + std::to_string(Width) + "_shared.rtbin";
+    if (SceneBinary::write_bvh_file(intact, "{}", *root, objects, config) == 0)
+    {
+        std::cerr << "FAIL: cannot write '" << intact << "'." << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+    auto binary = SceneBinary::open(intact);
+    bool adopted = binary && binary->adopt_bvh(objects, config);
+    std::cout << "BVH" << Width << " intact:       " << (adopted ? "adopted" : "rejected") << std::endl;
+    failures += !adopted;
+
+    std::vector<char> image = read_file(intact);
+    RtbinHeader header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    RtbinBVH record;
+    std::memcpy(&record, image.data() + header.bvh_offset, sizeof(record));
+    bool corrupted;
+    if constexpr (Width == 2)
+        corrupted = share_binary_child(image, record.node_count);
+    else
+        corrupted = share_wide_child<Width>(image, record.node_count);
+    if (!corrupted)
+    {
+        std::cerr << "FAIL: no node to corrupt in the BVH" << Width << "." << std::endl;
+        return failures + 1;
+    }
+    std::ofstream(corrupt, std::ios::binary).write(image.data(), static_cast<std::streamsize>(image.size()));
+
+    binary = SceneBinary::open(corrupt);
+    adopted = binary && binary->adopt_bvh(objects, config);
+    std::cout << "BVH" << Width << " shared child: " << (adopted ? "adopted" : "rejected") << std::endl;
+    failures += adopted;
+
+    std::remove(intact.c_str());
+    std::remove(corrupt.c_str());
+    return failures;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const std::string directory = argc > 1 ? argv[1] : ".";
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+    std::vector<std::shared_ptr<Hittable>> objects;
+    for (int i = 0; i < kSpheres; ++i)
+        objects.push_back(std::make_shared<Sphere>(Vec3(coordinate(rng), coordinate(rng), coordinate(rng)), 0.1f, 0));
+
+    int failures = check_width<2>(objects, directory) + check_width<4>(objects, directory) +
+                   check_width<8>(objects, directory);
+    if (failures > 0)
+    {
+        std::cerr << "FAIL: " << failures << " BVH files were handled wrongly." << std::endl;
+        return 1;
+    }
+    std::cout << "OK" << std::endl;
+    return 0;
+}